@@ -0,0 +1,289 @@
+//============================================================================
+// Name        : Benchmark.hpp
+// Description : Repeated-run benchmark harness with summary statistics
+//============================================================================
+
+#ifndef _BENCHMARK_HPP_
+#define _BENCHMARK_HPP_
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * How many times each measured function runs
+ */
+struct BenchmarkOptions {
+    unsigned warmup;        // untimed runs first, to fault in pages and train caches
+    unsigned iterations;    // timed runs the statistics are taken over
+    bool coldCache;         // evict the caches before every timed run
+
+    BenchmarkOptions(unsigned warmup = 1, unsigned iterations = 10, bool coldCache = false)
+        : warmup(warmup), iterations(iterations < 1 ? 1 : iterations), coldCache(coldCache) {
+    }
+};
+
+/**
+ * Timings of one function over all its measured runs
+ */
+struct BenchmarkStats {
+    std::string name;
+    std::string complexity;
+    size_t items;
+    std::vector<double> samplesMs;  // one per measured run, in run order
+    double minMs;
+    double medianMs;
+    double p95Ms;
+    double meanMs;
+    double stddevMs;
+
+    BenchmarkStats()
+        : items(0), minMs(0.0), medianMs(0.0), p95Ms(0.0), meanMs(0.0), stddevMs(0.0) {
+    }
+
+    /**
+     * @return Items processed per second at the median time
+     */
+    double itemsPerSecond() const {
+        return (medianMs > 0.0) ? static_cast<double>(items) * 1000.0 / medianMs : 0.0;
+    }
+};
+
+/**
+ * Runs a function repeatedly on fresh copies of its input and summarizes
+ * the timings
+ *
+ * Each run gets its own copy of the input, made before the clock starts, so
+ * sorts never see already-sorted data and the copy is never timed. Copies
+ * reuse one buffer, so after the first run no run allocates for its input.
+ *
+ * Making the copy leaves the input hot in cache. For cold-cache timings,
+ * BenchmarkOptions::coldCache evicts the caches between the copy and the
+ * clock by streaming through a buffer twice the size of the last-level
+ * cache.
+ */
+class Benchmark {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    /**
+     * @param name Label for the results
+     * @param complexity Complexity to report beside the timings
+     * @param input Data each run starts from; never modified
+     * @param run Called as run(copy) with a fresh copy of input
+     * @param options Warmup and measured run counts
+     * @return Statistics over the measured runs
+     */
+    template<typename Input, typename Run>
+    static BenchmarkStats measure(const std::string& name, const std::string& complexity, const Input& input,
+                                  Run run, const BenchmarkOptions& options) {
+        Input copy;
+        for (unsigned i = 0; i < options.warmup; ++i) {
+            copy = input;
+            run(copy);
+        }
+
+        std::vector<double> samples;
+        samples.reserve(options.iterations);
+        for (unsigned i = 0; i < options.iterations; ++i) {
+            copy = input;
+            if (options.coldCache) {
+                evictCaches();
+            }
+            auto start = Clock::now();
+            run(copy);
+            auto end = Clock::now();
+            samples.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+        }
+        return summarize(name, complexity, input.size(), samples);
+    }
+
+    /**
+     * Writes then reads one byte per cache line of a buffer twice the size
+     * of the last-level cache (at most 256 MiB), pushing everything else
+     * out of the cache hierarchy. The buffer is per thread, so concurrent
+     * benchmarks do not share one.
+     */
+    static void evictCaches() {
+        static thread_local std::vector<unsigned char> buffer;
+        if (buffer.empty()) {
+            buffer.resize(std::min<size_t>(2 * lastLevelCacheBytes(), static_cast<size_t>(256) << 20));
+        }
+        static thread_local unsigned char round = 0;
+        ++round;
+        for (size_t i = 0; i < buffer.size(); i += 64) {
+            buffer[i] = static_cast<unsigned char>(buffer[i] + round);
+        }
+        unsigned sum = 0;
+        for (size_t i = 0; i < buffer.size(); i += 64) {
+            sum += buffer[i];
+        }
+        // Storing the sum keeps the read loop from being optimized away
+        buffer[0] = static_cast<unsigned char>(sum);
+    }
+
+    /**
+     * @return Size of the largest CPU cache, from sysfs where there is one,
+     *         else a generous 32 MiB
+     */
+    static size_t lastLevelCacheBytes() {
+        static const size_t bytes = []() {
+            size_t largest = 0;
+            for (int index = 0; index < 8; ++index) {
+                std::ifstream in("/sys/devices/system/cpu/cpu0/cache/index" + std::to_string(index) + "/size");
+                uint64_t size = 0;
+                char unit = 0;
+                if (!(in >> size)) {
+                    continue;
+                }
+                in >> unit;
+                size *= (unit == 'K') ? 1024 : (unit == 'M') ? 1024 * 1024 : 1;
+                largest = std::max<size_t>(largest, static_cast<size_t>(size));
+            }
+            return largest > 0 ? largest : static_cast<size_t>(32) << 20;
+        }();
+        return bytes;
+    }
+
+    /**
+     * Computes min, median, 95th percentile (nearest rank), mean and sample
+     * standard deviation of a set of timings
+     */
+    static BenchmarkStats summarize(const std::string& name, const std::string& complexity, size_t items,
+                                    const std::vector<double>& samplesMs) {
+        BenchmarkStats stats;
+        stats.name = name;
+        stats.complexity = complexity;
+        stats.items = items;
+        stats.samplesMs = samplesMs;
+        if (samplesMs.empty()) {
+            return stats;
+        }
+
+        std::vector<double> sorted(samplesMs);
+        std::sort(sorted.begin(), sorted.end());
+        size_t n = sorted.size();
+
+        stats.minMs = sorted.front();
+        stats.medianMs = (n % 2 == 1) ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2.0;
+        size_t rank = static_cast<size_t>(std::ceil(0.95 * static_cast<double>(n)));
+        stats.p95Ms = sorted[(rank == 0) ? 0 : rank - 1];
+
+        double sum = 0.0;
+        for (double sample : sorted) {
+            sum += sample;
+        }
+        stats.meanMs = sum / static_cast<double>(n);
+
+        if (n > 1) {
+            double squares = 0.0;
+            for (double sample : sorted) {
+                squares += (sample - stats.meanMs) * (sample - stats.meanMs);
+            }
+            stats.stddevMs = std::sqrt(squares / static_cast<double>(n - 1));
+        }
+        return stats;
+    }
+
+    /**
+     * Writes one CSV row per result, with a header row
+     *
+     * @param out Stream to write to
+     * @param results Results to write
+     * @param options Run counts the results were measured with
+     * @param label Describes the input, e.g. the sort order; repeated on
+     *        each row so files from several runs can be concatenated
+     * @param header false to leave out the header row, when appending
+     */
+    static void writeCsv(std::ostream& out, const std::vector<BenchmarkStats>& results,
+                         const BenchmarkOptions& options, const std::string& label, bool header = true) {
+        if (header) {
+            out << "label,algorithm,complexity,items,warmup,iterations,"
+                   "min_ms,median_ms,p95_ms,mean_ms,stddev_ms,items_per_s\n";
+        }
+        out << std::fixed << std::setprecision(6);
+        for (const auto& result : results) {
+            out << csvField(label) << ',' << csvField(result.name) << ',' << csvField(result.complexity) << ','
+                << result.items << ',' << options.warmup << ',' << result.samplesMs.size() << ','
+                << result.minMs << ',' << result.medianMs << ',' << result.p95Ms << ','
+                << result.meanMs << ',' << result.stddevMs << ',' << result.itemsPerSecond() << '\n';
+        }
+    }
+
+    /**
+     * Writes the results, including every sample, as one JSON object
+     *
+     * @param out Stream to write to
+     * @param results Results to write
+     * @param options Run counts the results were measured with
+     * @param label Describes the input, e.g. the sort order
+     */
+    static void writeJson(std::ostream& out, const std::vector<BenchmarkStats>& results,
+                          const BenchmarkOptions& options, const std::string& label) {
+        out << std::fixed << std::setprecision(6);
+        out << "{\n  \"label\": " << jsonString(label)
+            << ",\n  \"warmup\": " << options.warmup
+            << ",\n  \"iterations\": " << options.iterations
+            << ",\n  \"results\": [";
+        for (size_t i = 0; i < results.size(); ++i) {
+            const BenchmarkStats& result = results[i];
+            out << (i == 0 ? "\n" : ",\n")
+                << "    {\"algorithm\": " << jsonString(result.name)
+                << ", \"complexity\": " << jsonString(result.complexity)
+                << ", \"items\": " << result.items
+                << ", \"min_ms\": " << result.minMs
+                << ", \"median_ms\": " << result.medianMs
+                << ", \"p95_ms\": " << result.p95Ms
+                << ", \"mean_ms\": " << result.meanMs
+                << ", \"stddev_ms\": " << result.stddevMs
+                << ", \"items_per_s\": " << result.itemsPerSecond()
+                << ", \"samples_ms\": [";
+            for (size_t j = 0; j < result.samplesMs.size(); ++j) {
+                out << (j == 0 ? "" : ", ") << result.samplesMs[j];
+            }
+            out << "]}";
+        }
+        out << "\n  ]\n}\n";
+    }
+
+private:
+    static std::string csvField(const std::string& text) {
+        std::string quoted = "\"";
+        for (char c : text) {
+            if (c == '"') quoted += '"';
+            quoted += c;
+        }
+        return quoted + "\"";
+    }
+
+    static std::string jsonString(const std::string& text) {
+        static const char* hex = "0123456789abcdef";
+        std::string quoted = "\"";
+        for (char c : text) {
+            unsigned char byte = static_cast<unsigned char>(c);
+            if (c == '"' || c == '\\') {
+                quoted += '\\';
+                quoted += c;
+            }
+            else if (byte < 0x20 || byte >= 0x80) {
+                // Escape control bytes, and Latin-1 bytes that would not be valid UTF-8
+                quoted += "\\u00";
+                quoted += hex[byte >> 4];
+                quoted += hex[byte & 0xF];
+            }
+            else {
+                quoted += c;
+            }
+        }
+        return quoted + "\"";
+    }
+};
+
+#endif /*!_BENCHMARK_HPP_*/
@@ -0,0 +1,353 @@
+//============================================================================
+// Name        : BenchmarkRunner.hpp
+// Description : Runs independent benchmarks concurrently on pinned cores, or isolated on one
+//============================================================================
+
+#ifndef _BENCHMARKRUNNER_HPP_
+#define _BENCHMARKRUNNER_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+# ifndef NOMINMAX
+#  define NOMINMAX
+# endif
+# define WIN32_LEAN_AND_MEAN
+# include <windows.h>
+#elif defined(__linux__)
+# include <pthread.h>
+# include <sched.h>
+#endif
+
+#include "Benchmark.hpp"
+
+/**
+ * How BenchmarkRunner schedules its jobs
+ */
+enum BenchmarkMode {
+    eBENCH_SEQUENTIAL = 0,  // one after another on the calling thread, unpinned
+    eBENCH_CONCURRENT = 1,  // one job per core at a time, each thread pinned to its core
+    eBENCH_ISOLATED = 2     // one after another on a single pinned core
+};
+
+/**
+ * One independent benchmark: measure(options) times it, typically through
+ * Benchmark::measure, on data it only reads
+ */
+struct BenchmarkJob {
+    std::string name;
+    std::function<BenchmarkStats(const BenchmarkOptions&)> measure;
+    bool longRunning = false;   // started first, so the slowest job does not start last
+    bool usesPool = false;      // forks onto ThreadPool::shared(); never run beside other jobs
+};
+
+/**
+ * What a run of BenchmarkRunner did besides the timings
+ */
+struct BenchmarkRunReport {
+    double wallMs = 0.0;        // first job started to last job done
+    double busyMs = 0.0;        // the jobs' own wall times, summed
+    size_t threads = 0;         // jobs running at once, at most
+    bool pinned = false;        // every benchmark thread was pinned to its core
+    std::vector<std::string> notes;     // CPU frequency and scheduling caveats
+};
+
+/**
+ * CPU affinity and frequency-scaling information for the current process
+ */
+class CpuTopology {
+public:
+    /**
+     * @return The CPUs this process may run on, ascending; 0..n-1 where
+     *         the platform does not say
+     */
+    static std::vector<int> availableCpus() {
+        std::vector<int> cpus;
+#if defined(_WIN32)
+        DWORD_PTR process = 0, system = 0;
+        if (GetProcessAffinityMask(GetCurrentProcess(), &process, &system)) {
+            for (int cpu = 0; cpu < static_cast<int>(sizeof(DWORD_PTR) * 8); ++cpu) {
+                if (process & (static_cast<DWORD_PTR>(1) << cpu)) {
+                    cpus.push_back(cpu);
+                }
+            }
+        }
+#elif defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                if (CPU_ISSET(cpu, &set)) {
+                    cpus.push_back(cpu);
+                }
+            }
+        }
+#endif
+        if (cpus.empty()) {
+            unsigned count = std::max(1u, std::thread::hardware_concurrency());
+            for (unsigned cpu = 0; cpu < count; ++cpu) {
+                cpus.push_back(static_cast<int>(cpu));
+            }
+        }
+        return cpus;
+    }
+
+    /**
+     * Restricts the calling thread to one CPU
+     *
+     * @return false if the platform has no thread affinity or refused it
+     */
+    static bool pinCurrentThread(int cpu) {
+#if defined(_WIN32)
+        if (cpu < 0 || cpu >= static_cast<int>(sizeof(DWORD_PTR) * 8)) {
+            return false;
+        }
+        return SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(1) << cpu) != 0;
+#elif defined(__linux__)
+        if (cpu < 0 || cpu >= CPU_SETSIZE) {
+            return false;
+        }
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+        (void)cpu;
+        return false;
+#endif
+    }
+
+    /**
+     * Describes how the CPU's clock may move under a benchmark running on
+     * it: the governor, the frequency range and turbo, with what to
+     * change for steadier numbers. Linux cpufreq only; elsewhere a single
+     * line saying nothing could be read.
+     */
+    static std::vector<std::string> frequencyNotes(int cpu) {
+        std::vector<std::string> notes;
+        std::string base = "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/cpufreq/";
+        std::string governor = readLine(base + "scaling_governor");
+        std::string current = readLine(base + "scaling_cur_freq");
+        std::string low = readLine(base + "scaling_min_freq");
+        std::string high = readLine(base + "scaling_max_freq");
+        if (governor.empty() && current.empty()) {
+            notes.push_back("CPU " + std::to_string(cpu) + ": frequency scaling information not available; "
+                            "times may include clock ramp-up and turbo variation");
+            return notes;
+        }
+        std::string line = "CPU " + std::to_string(cpu) + ": governor " + (governor.empty() ? "unknown" : governor);
+        if (!current.empty()) {
+            line += ", at " + megahertz(current);
+        }
+        if (!low.empty() && !high.empty()) {
+            line += " (range " + megahertz(low) + " to " + megahertz(high) + ")";
+        }
+        notes.push_back(line);
+        if (!governor.empty() && governor != "performance") {
+            notes.push_back("  the '" + governor + "' governor changes the clock with load; "
+                            "the 'performance' governor gives steadier times");
+        }
+
+        std::string noTurbo = readLine("/sys/devices/system/cpu/intel_pstate/no_turbo");
+        std::string boost = readLine("/sys/devices/system/cpu/cpufreq/boost");
+        if (noTurbo == "0" || boost == "1") {
+            notes.push_back("  turbo is on: the clock depends on temperature and on how many cores are busy, "
+                            "so concurrent and isolated times differ");
+        }
+        return notes;
+    }
+
+private:
+    static std::string readLine(const std::string& path) {
+        std::ifstream in(path);
+        std::string line;
+        std::getline(in, line);
+        return line;
+    }
+
+    static std::string megahertz(const std::string& kilohertz) {
+        try {
+            return std::to_string(std::stoll(kilohertz) / 1000) + " MHz";
+        }
+        catch (const std::exception&) {
+            return kilohertz + " kHz";
+        }
+    }
+};
+
+/**
+ * Runs a set of independent benchmark jobs and collects their statistics
+ *
+ * Concurrent mode starts one thread per available CPU (or per job, if
+ * fewer), pins each to its own CPU, highest numbered first since CPU 0
+ * tends to take the most interrupts, and lets the threads pull jobs off a
+ * shared list, long-running jobs first. The whole comparison then takes
+ * about as long as its slowest job rather than the sum of all of them,
+ * but the jobs share the last-level cache, memory bandwidth and the turbo
+ * budget, so times run higher than they would alone. Jobs that fork onto
+ * the shared thread pool run afterwards, one at a time with every core.
+ *
+ * Isolated mode runs every job, one after another, on one dedicated
+ * thread pinned to the highest numbered CPU, after 200 ms of spinning
+ * there so the clock has ramped up before the first measurement. These
+ * are the numbers to quote.
+ *
+ * Results come back in job order whatever order the jobs ran in.
+ */
+class BenchmarkRunner {
+public:
+    /**
+     * @param jobs Benchmarks to run
+     * @param mode How to schedule them
+     * @param options Warmup, iteration and cache settings for every job
+     * @param report Receives wall time, threads and notes
+     * @return One result per job, in job order
+     * @throws Whatever a job throws, after every started job finished
+     */
+    static std::vector<BenchmarkStats> run(const std::vector<BenchmarkJob>& jobs, BenchmarkMode mode,
+                                           const BenchmarkOptions& options, BenchmarkRunReport& report) {
+        typedef std::chrono::steady_clock Clock;
+        report = BenchmarkRunReport();
+        std::vector<BenchmarkStats> results(jobs.size());
+        std::vector<int> cpus = CpuTopology::availableCpus();
+        std::mutex busyMutex;
+        auto runJob = [&](size_t index) {
+            auto start = Clock::now();
+            results[index] = jobs[index].measure(options);
+            double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            std::lock_guard<std::mutex> lock(busyMutex);
+            report.busyMs += ms;
+        };
+
+        auto started = Clock::now();
+        if (mode == eBENCH_SEQUENTIAL) {
+            report.threads = 1;
+            for (size_t i = 0; i < jobs.size(); ++i) {
+                runJob(i);
+            }
+        }
+        else if (mode == eBENCH_ISOLATED) {
+            int cpu = cpus.back();
+            report.threads = 1;
+            report.notes = CpuTopology::frequencyNotes(cpu);
+            std::exception_ptr error;
+            std::thread isolated([&]() {
+                report.pinned = CpuTopology::pinCurrentThread(cpu);
+                spin(std::chrono::milliseconds(200));
+                try {
+                    for (size_t i = 0; i < jobs.size(); ++i) {
+                        runJob(i);
+                    }
+                }
+                catch (...) {
+                    error = std::current_exception();
+                }
+            });
+            isolated.join();
+            if (error) {
+                std::rethrow_exception(error);
+            }
+            std::vector<std::string> after = CpuTopology::frequencyNotes(cpu);
+            if (!after.empty() && after.front() != report.notes.front()) {
+                report.notes.push_back("After the run: " + after.front());
+            }
+            if (std::any_of(jobs.begin(), jobs.end(), [](const BenchmarkJob& job) { return job.usesPool; })) {
+                report.notes.push_back("Parallel sorts fork onto unpinned pool threads; only their calling "
+                                       "thread stays on CPU " + std::to_string(cpu));
+            }
+            if (!report.pinned) {
+                report.notes.push_back("Could not pin to CPU " + std::to_string(cpu) + "; runs were not isolated");
+            }
+        }
+        else {
+            runConcurrent(jobs, cpus, runJob, report);
+        }
+        report.wallMs = std::chrono::duration<double, std::milli>(Clock::now() - started).count();
+        return results;
+    }
+
+private:
+    template<typename RunJob>
+    static void runConcurrent(const std::vector<BenchmarkJob>& jobs, const std::vector<int>& cpus,
+                              RunJob& runJob, BenchmarkRunReport& report) {
+        std::vector<size_t> order;
+        std::vector<size_t> pooled;
+        for (size_t i = 0; i < jobs.size(); ++i) {
+            (jobs[i].usesPool ? pooled : order).push_back(i);
+        }
+        std::stable_partition(order.begin(), order.end(), [&jobs](size_t i) { return jobs[i].longRunning; });
+
+        size_t threads = std::min(cpus.size(), order.size());
+        std::atomic<size_t> next(0);
+        std::atomic<bool> allPinned(true);
+        std::mutex errorMutex;
+        std::exception_ptr error;
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < threads; ++t) {
+            int cpu = cpus[cpus.size() - 1 - t];
+            workers.emplace_back([&, cpu]() {
+                if (!CpuTopology::pinCurrentThread(cpu)) {
+                    allPinned.store(false);
+                }
+                for (size_t slot = next.fetch_add(1); slot < order.size(); slot = next.fetch_add(1)) {
+                    try {
+                        runJob(order[slot]);
+                    }
+                    catch (...) {
+                        std::lock_guard<std::mutex> lock(errorMutex);
+                        if (!error) {
+                            error = std::current_exception();
+                        }
+                    }
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+
+        // Parallel jobs would steal cores from the pinned ones; give them the machine
+        for (size_t i : pooled) {
+            runJob(i);
+        }
+
+        report.threads = std::max<size_t>(threads, pooled.empty() ? 0 : 1);
+        report.pinned = threads > 0 && allPinned.load();
+        report.notes.push_back(std::to_string(threads) + (threads == 1 ? " job" : " jobs") + " at a time on "
+                               + std::to_string(cpus.size())
+                               + " available CPUs; they share caches, memory bandwidth and turbo headroom, "
+                                 "so use isolated mode for numbers to quote");
+        if (threads > 0 && !report.pinned) {
+            report.notes.push_back("Could not pin every benchmark thread; the scheduler may have moved them");
+        }
+        if (!pooled.empty()) {
+            report.notes.push_back(std::to_string(pooled.size())
+                                   + " parallel sorts ran afterwards, one at a time on every core");
+        }
+    }
+
+    /**
+     * Busy-waits for duration, to bring the core's clock up to speed
+     */
+    static void spin(std::chrono::steady_clock::duration duration) {
+        auto until = std::chrono::steady_clock::now() + duration;
+        volatile unsigned counter = 0;
+        while (std::chrono::steady_clock::now() < until) {
+            counter = counter + 1;
+        }
+    }
+};
+
+#endif /*!_BENCHMARKRUNNER_HPP_*/
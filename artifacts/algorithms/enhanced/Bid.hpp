@@ -0,0 +1,285 @@
+//============================================================================
+// Name        : Bid.hpp
+// Description : Bid record, BidArena text storage and columnar BidTable
+//============================================================================
+
+#ifndef _BID_HPP_
+#define _BID_HPP_
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include "Instrumentation.hpp"
+
+/**
+ * Structure to hold bid information
+ *
+ * The text fields are views: the characters belong to a BidArena (or a
+ * BidTable) that must outlive the bid. Copying a Bid never copies text.
+ */
+struct Bid {
+    std::string_view bidId;    // unique identifier
+    std::string_view title;    // bid title for sorting
+    std::string_view fund;     // fund information
+    double amount;             // bid amount
+
+    Bid() : amount(0.0) {}
+};
+
+/**
+ * Monotonic arena owning the text of a bid set
+ *
+ * Strings are bump-allocated into large blocks, so a bulk load costs a
+ * handful of allocations instead of three per bid, and release() hands the
+ * whole set back at once. intern() additionally shares repeated values
+ * (funds take a few dozen distinct strings across thousands of bids).
+ * Nothing is freed individually; views stay valid until release().
+ * adopt() lets views into storage the arena did not copy, such as a
+ * mapped snapshot, share that lifetime.
+ */
+class BidArena {
+public:
+    explicit BidArena(size_t blockSize = 1 << 20)
+        : blockSize(blockSize), cursor(nullptr), remaining(0), used(0) {
+    }
+
+    BidArena(const BidArena&) = delete;
+    BidArena& operator=(const BidArena&) = delete;
+
+    /**
+     * Copies text into the arena
+     *
+     * @param text Characters to copy
+     * @return View of the arena-owned copy
+     */
+    std::string_view copy(std::string_view text) {
+        if (text.empty()) {
+            return std::string_view();
+        }
+        if (text.size() > remaining) {
+            grow(text.size());
+        }
+        char* out = cursor;
+        std::memcpy(out, text.data(), text.size());
+        Instrumentation::noteStringCopy();
+        cursor += text.size();
+        remaining -= text.size();
+        used += text.size();
+        return std::string_view(out, text.size());
+    }
+
+    /**
+     * Copies text into the arena once; equal strings share one copy
+     *
+     * @param text Characters to intern
+     * @return View of the shared arena-owned copy
+     */
+    std::string_view intern(std::string_view text) {
+        auto found = interned.find(text);
+        if (found != interned.end()) {
+            return *found;
+        }
+        std::string_view stored = copy(text);
+        interned.insert(stored);
+        return stored;
+    }
+
+    /**
+     * Keeps owner alive until release(), for bid text that points into it
+     * instead of into the arena's own blocks
+     *
+     * @param owner Storage that views are handed out into, e.g. a mapped file
+     */
+    void adopt(std::shared_ptr<const void> owner) {
+        owners.push_back(std::move(owner));
+    }
+
+    /**
+     * Frees every block and adopted owner; all views handed out become invalid
+     */
+    void release() {
+        interned.clear();
+        blocks.clear();
+        owners.clear();
+        cursor = nullptr;
+        remaining = 0;
+        used = 0;
+    }
+
+    size_t bytesUsed() const { return used; }
+    size_t blockCount() const { return blocks.size(); }
+
+private:
+    void grow(size_t atLeast) {
+        size_t size = (atLeast > blockSize) ? atLeast : blockSize;
+        blocks.emplace_back(new char[size]);
+        cursor = blocks.back().get();
+        remaining = size;
+    }
+
+    size_t blockSize;
+    std::vector<std::unique_ptr<char[]>> blocks;
+    std::vector<std::shared_ptr<const void>> owners;
+    char* cursor;
+    size_t remaining;
+    size_t used;
+    std::unordered_set<std::string_view> interned;
+};
+
+/**
+ * Columnar (struct-of-arrays) storage for a set of bids
+ *
+ * Each text column is one contiguous character pool plus an offset array,
+ * and amounts are a dense array of doubles. Sorting works on a permutation
+ * of row indices (see BidSorter), so a comparison only touches the bytes
+ * of the column it needs and nothing is moved but 4-byte indices.
+ */
+class BidTable {
+public:
+    BidTable() {}
+
+    /**
+     * Builds a table holding a copy of the given bids, in order
+     *
+     * @param bids Bids to copy into columnar form
+     */
+    explicit BidTable(const std::vector<Bid>& bids) {
+        size_t textBytes = 0;
+        for (const auto& bid : bids) {
+            textBytes += bid.title.size();
+        }
+        reserve(bids.size(), textBytes);
+        for (const auto& bid : bids) {
+            append(bid);
+        }
+    }
+
+    /**
+     * Pre-sizes the columns
+     *
+     * @param rows Expected number of rows
+     * @param titleBytes Expected total size of all titles
+     */
+    void reserve(size_t rows, size_t titleBytes = 0) {
+        idColumn.reserve(rows, rows * 8);
+        titleColumn.reserve(rows, titleBytes);
+        fundColumn.reserve(rows, rows * 16);
+        amounts.reserve(rows);
+    }
+
+    /**
+     * Appends one row
+     *
+     * @param bid Bid whose fields are copied into the columns
+     */
+    void append(const Bid& bid) {
+        append(bid.bidId, bid.title, bid.fund, bid.amount);
+    }
+
+    void append(std::string_view bidId, std::string_view title, std::string_view fund, double amount) {
+        idColumn.append(bidId);
+        titleColumn.append(title);
+        fundColumn.append(fund);
+        amounts.push_back(amount);
+    }
+
+    size_t size() const { return amounts.size(); }
+    bool empty() const { return amounts.empty(); }
+
+    std::string_view bidId(size_t row) const { return idColumn.at(row); }
+    std::string_view title(size_t row) const { return titleColumn.at(row); }
+    std::string_view fund(size_t row) const { return fundColumn.at(row); }
+    double amount(size_t row) const { return amounts[row]; }
+
+    /**
+     * Rebuilds a row as a Bid viewing this table's columns
+     *
+     * @param row Row index
+     * @return Bid whose fields stay valid while the table is unchanged
+     */
+    Bid toBid(size_t row) const {
+        Bid bid;
+        bid.bidId = bidId(row);
+        bid.title = title(row);
+        bid.fund = fund(row);
+        bid.amount = amount(row);
+        return bid;
+    }
+
+    /**
+     * Materializes the rows in the given order, e.g. a sorted permutation
+     *
+     * @param order Row indices to gather
+     * @return Vector of Bid objects (viewing this table) in that order
+     */
+    std::vector<Bid> toBids(const std::vector<uint32_t>& order) const {
+        std::vector<Bid> bids;
+        bids.reserve(order.size());
+        for (uint32_t row : order) {
+            bids.push_back(toBid(row));
+        }
+        return bids;
+    }
+
+    /**
+     * @return The identity permutation 0..size()-1
+     */
+    std::vector<uint32_t> identity() const {
+        std::vector<uint32_t> order(size());
+        for (size_t i = 0; i < order.size(); ++i) {
+            order[i] = static_cast<uint32_t>(i);
+        }
+        return order;
+    }
+
+    void clear() {
+        idColumn.clear();
+        titleColumn.clear();
+        fundColumn.clear();
+        amounts.clear();
+    }
+
+private:
+    /**
+     * One text column: row i is pool[offsets[i], offsets[i + 1])
+     */
+    struct StringColumn {
+        std::string pool;
+        std::vector<uint32_t> offsets{ 0 };
+
+        void reserve(size_t rows, size_t bytes) {
+            offsets.reserve(rows + 1);
+            pool.reserve(bytes);
+        }
+
+        void append(std::string_view text) {
+            if (pool.size() + text.size() > UINT32_MAX) {
+                throw std::length_error("BidTable column exceeds 4 GiB");
+            }
+            pool.append(text.data(), text.size());
+            offsets.push_back(static_cast<uint32_t>(pool.size()));
+        }
+
+        std::string_view at(size_t row) const {
+            return std::string_view(pool.data() + offsets[row], offsets[row + 1] - offsets[row]);
+        }
+
+        void clear() {
+            pool.clear();
+            offsets.assign(1, 0);
+        }
+    };
+
+    StringColumn idColumn;
+    StringColumn titleColumn;
+    StringColumn fundColumn;
+    std::vector<double> amounts;
+};
+
+#endif /*!_BID_HPP_*/
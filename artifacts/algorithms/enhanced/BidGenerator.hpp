@@ -0,0 +1,124 @@
+//============================================================================
+// Name        : BidGenerator.hpp
+// Description : Synthetic bid sets of any size and key distribution
+//============================================================================
+
+#ifndef _BIDGENERATOR_HPP_
+#define _BIDGENERATOR_HPP_
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Bid.hpp"
+
+/**
+ * Shapes of generated input, each stressing the sorts differently
+ */
+enum BidDistribution {
+    eRANDOM = 0,        // random multi-word titles and amounts
+    eSORTED = 1,        // already in title, id and amount order
+    eREVERSED = 2,      // in descending title, id and amount order
+    eDUPLICATES = 3,    // 16 distinct titles and 16 distinct amounts
+    eSHARED_PREFIX = 4  // titles share a 61-byte prefix, differing only after it
+};
+
+/**
+ * Produces reproducible bid sets for benchmarking: the same count,
+ * distribution and seed always give the same bids
+ */
+class BidGenerator {
+public:
+    static const int DISTRIBUTION_COUNT = 5;
+
+    /**
+     * @return Short lowercase name for reports, e.g. "shared-prefix"
+     */
+    static const char* name(BidDistribution distribution) {
+        static const char* names[] = { "random", "sorted", "reversed", "duplicates", "shared-prefix" };
+        return names[distribution];
+    }
+
+    /**
+     * @param count Number of bids
+     * @param distribution Shape of the titles and amounts
+     * @param arena Arena that takes ownership of the generated text
+     * @param seed Random seed
+     * @return Generated bids; ids are unique 8-digit numbers
+     */
+    static std::vector<Bid> generate(size_t count, BidDistribution distribution, BidArena& arena,
+                                     uint32_t seed = 12345) {
+        static const char* words[] = {
+            "Surplus", "Vehicle", "Office", "Desk", "Chair", "Computer", "Printer", "Monitor",
+            "Truck", "Mower", "Tractor", "Trailer", "Police", "Cruiser", "Lot", "Parts",
+            "Steel", "Cabinet", "Bicycle", "Generator", "Pump", "Radio", "Tools", "Lumber",
+            "Furniture", "School", "Bus", "Scrap", "Metal", "Copier", "Server", "Equipment"
+        };
+        static const size_t wordCount = sizeof(words) / sizeof(words[0]);
+        static const char* funds[] = { "General Fund", "Enterprise", "Special Revenue", "Capital Projects" };
+        static const char* prefix = "Metropolitan Government Surplus Property Auction, Lot Number ";
+
+        std::mt19937 random(seed);
+        std::vector<Bid> bids(count);
+        std::string title;
+        char digits[32];
+
+        for (size_t i = 0; i < count; ++i) {
+            // Rank of the bid in the sorted and reversed orders
+            size_t rank = (distribution == eREVERSED) ? count - 1 - i : i;
+
+            std::snprintf(digits, sizeof(digits), "%08zu", (distribution == eSORTED || distribution == eREVERSED) ? rank : i);
+            bids[i].bidId = arena.copy(digits);
+            bids[i].fund = arena.intern(funds[random() % 4]);
+
+            switch (distribution) {
+            case eSORTED:
+            case eREVERSED:
+                std::snprintf(digits, sizeof(digits), "Item %09zu", rank);
+                bids[i].title = arena.copy(digits);
+                bids[i].amount = static_cast<double>(rank) / 2.0;
+                break;
+
+            case eDUPLICATES:
+                bids[i].title = arena.intern(words[random() % 16]);
+                bids[i].amount = static_cast<double>(random() % 16) * 100.0;
+                break;
+
+            case eSHARED_PREFIX:
+                std::snprintf(digits, sizeof(digits), "%09u", static_cast<unsigned>(random() % 1000000000u));
+                title.assign(prefix);
+                title += digits;
+                bids[i].title = arena.copy(title);
+                bids[i].amount = randomAmount(random);
+                break;
+
+            default: {
+                size_t length = 2 + random() % 3;
+                title.clear();
+                for (size_t w = 0; w < length; ++w) {
+                    title += words[random() % wordCount];
+                    title += ' ';
+                }
+                title += std::to_string(random() % 1000000);
+                bids[i].title = arena.copy(title);
+                bids[i].amount = randomAmount(random);
+                break;
+            }
+            }
+        }
+        return bids;
+    }
+
+private:
+    /**
+     * @return Whole cents between $0.00 and $99,999.99
+     */
+    static double randomAmount(std::mt19937& random) {
+        return static_cast<double>(random() % 10000000u) / 100.0;
+    }
+};
+
+#endif /*!_BIDGENERATOR_HPP_*/
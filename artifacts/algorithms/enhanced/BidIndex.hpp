@@ -0,0 +1,247 @@
+//============================================================================
+// Name        : BidIndex.hpp
+// Description : Secondary indexes on bid id, fund and amount
+//============================================================================
+
+#ifndef _BIDINDEX_HPP_
+#define _BIDINDEX_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Bid.hpp"
+#include "BidSorter.hpp"
+
+/**
+ * Lookup structures over a set of bids, kept beside the bid vector
+ *
+ * The index keeps its own copy of every Bid (views, so no text is copied)
+ * and refers to them by row: the insertion number, which does not change
+ * when the bid vector is sorted. Three indexes share the rows:
+ *
+ *  - bid id: open-addressing hash table with linear probing, at most half
+ *    full, holding row numbers; O(1) expected per lookup
+ *  - amount: (amount, row) pairs kept sorted, so a range query is two
+ *    binary searches; O(log n + matches)
+ *  - fund: a posting list of rows per distinct fund, in insertion order
+ *
+ * Bid ids are not guaranteed unique (the sample export repeats a few), so
+ * an id lookup returns every bid with that id.
+ */
+class BidIndex {
+public:
+    BidIndex() : used(0) {}
+
+    /**
+     * Replaces the index contents with the given bids
+     *
+     * @param bids Bids to index; their text must outlive the index
+     */
+    void build(const std::vector<Bid>& bids) {
+        clear();
+        records = bids;
+
+        resizeSlots(records.size());
+        for (size_t row = 0; row < records.size(); ++row) {
+            placeId(static_cast<uint32_t>(row));
+        }
+
+        amounts.resize(records.size());
+        for (size_t row = 0; row < records.size(); ++row) {
+            amounts[row] = AmountEntry{ records[row].amount, static_cast<uint32_t>(row) };
+        }
+        BidSorter::introSortBy(amounts, AmountLess());
+
+        for (size_t row = 0; row < records.size(); ++row) {
+            postings[records[row].fund].push_back(static_cast<uint32_t>(row));
+        }
+    }
+
+    /**
+     * Adds one bid to every index
+     * Time Complexity: O(1) expected for id and fund, O(n) worst case for
+     * the shift that keeps the amount index sorted
+     *
+     * @param bid Bid whose text must outlive the index
+     */
+    void insert(const Bid& bid) {
+        uint32_t row = static_cast<uint32_t>(records.size());
+        records.push_back(bid);
+
+        if ((used + 1) * 2 > slots.size()) {
+            resizeSlots(records.size());
+            for (uint32_t i = 0; i < row; ++i) {
+                placeId(i);
+            }
+        }
+        placeId(row);
+
+        // Equal amounts stay in insertion order, as build() orders them
+        AmountEntry entry{ bid.amount, row };
+        amounts.insert(std::upper_bound(amounts.begin(), amounts.end(), entry, AmountLess()), entry);
+
+        postings[bid.fund].push_back(row);
+    }
+
+    /**
+     * Adds a batch of bids to every index, merging the batch into the
+     * amount index in one pass instead of shifting it once per bid
+     *
+     * @param batch Bids whose text must outlive the index
+     */
+    void insert(const std::vector<Bid>& batch) {
+        size_t old = records.size();
+        records.insert(records.end(), batch.begin(), batch.end());
+
+        if (used + batch.size() > slots.size() / 2) {
+            resizeSlots(records.size());
+            for (size_t row = 0; row < old; ++row) {
+                placeId(static_cast<uint32_t>(row));
+            }
+        }
+        for (size_t row = old; row < records.size(); ++row) {
+            placeId(static_cast<uint32_t>(row));
+            amounts.push_back(AmountEntry{ records[row].amount, static_cast<uint32_t>(row) });
+            postings[records[row].fund].push_back(static_cast<uint32_t>(row));
+        }
+
+        // Sort only the new entries, then merge them with the indexed ones
+        BidSorter::introSortBy(amounts, old, amounts.size(), AmountLess());
+        std::inplace_merge(amounts.begin(), amounts.begin() + old, amounts.end(), AmountLess());
+    }
+
+    /**
+     * Drops every index; call before the text the bids view is released
+     */
+    void clear() {
+        records.clear();
+        slots.clear();
+        used = 0;
+        amounts.clear();
+        postings.clear();
+    }
+
+    size_t size() const { return records.size(); }
+    bool empty() const { return records.empty(); }
+
+    /**
+     * @param bidId Id to look up
+     * @return Every bid with that id, in insertion order
+     */
+    std::vector<Bid> findById(std::string_view bidId) const {
+        std::vector<Bid> found;
+        if (slots.empty()) {
+            return found;
+        }
+        size_t mask = slots.size() - 1;
+        for (size_t i = hashId(bidId) & mask; slots[i] != EMPTY; i = (i + 1) & mask) {
+            if (records[slots[i]].bidId == bidId) {
+                found.push_back(records[slots[i]]);
+            }
+        }
+        return found;
+    }
+
+    /**
+     * @param fund Fund to look up (exact match)
+     * @return Every bid paid from that fund, in insertion order
+     */
+    std::vector<Bid> findByFund(std::string_view fund) const {
+        std::vector<Bid> found;
+        auto list = postings.find(fund);
+        if (list != postings.end()) {
+            found.reserve(list->second.size());
+            for (uint32_t row : list->second) {
+                found.push_back(records[row]);
+            }
+        }
+        return found;
+    }
+
+    /**
+     * @param low Smallest amount wanted
+     * @param high Largest amount wanted
+     * @return Every bid with low <= amount <= high, by ascending amount
+     */
+    std::vector<Bid> findByAmount(double low, double high) const {
+        std::vector<Bid> found;
+        auto first = std::lower_bound(amounts.begin(), amounts.end(), low,
+            [](const AmountEntry& entry, double value) { return entry.amount < value; });
+        auto last = std::upper_bound(first, amounts.end(), high,
+            [](double value, const AmountEntry& entry) { return value < entry.amount; });
+        if (first < last) {
+            found.reserve(static_cast<size_t>(last - first));
+        }
+        for (; first < last; ++first) {
+            found.push_back(records[first->row]);
+        }
+        return found;
+    }
+
+    /**
+     * @return Each distinct fund with the number of bids paid from it
+     */
+    std::vector<std::pair<std::string_view, size_t>> funds() const {
+        std::vector<std::pair<std::string_view, size_t>> counts;
+        counts.reserve(postings.size());
+        for (const auto& list : postings) {
+            counts.emplace_back(list.first, list.second.size());
+        }
+        std::sort(counts.begin(), counts.end());
+        return counts;
+    }
+
+private:
+    static constexpr uint32_t EMPTY = UINT32_MAX;
+
+    struct AmountEntry {
+        double amount;
+        uint32_t row;
+    };
+
+    struct AmountLess {
+        bool operator()(const AmountEntry& a, const AmountEntry& b) const {
+            return a.amount < b.amount || (!(b.amount < a.amount) && a.row < b.row);
+        }
+    };
+
+    static size_t hashId(std::string_view bidId) {
+        return std::hash<std::string_view>()(bidId);
+    }
+
+    /**
+     * Empties the hash table, sized to stay at most half full for rows
+     */
+    void resizeSlots(size_t rows) {
+        size_t capacity = 16;
+        while (capacity < rows * 2) {
+            capacity <<= 1;
+        }
+        slots.assign(capacity, EMPTY);
+        used = 0;
+    }
+
+    void placeId(uint32_t row) {
+        size_t mask = slots.size() - 1;
+        size_t i = hashId(records[row].bidId) & mask;
+        while (slots[i] != EMPTY) {
+            i = (i + 1) & mask;
+        }
+        slots[i] = row;
+        ++used;
+    }
+
+    std::vector<Bid> records;
+    std::vector<uint32_t> slots;
+    size_t used;
+    std::vector<AmountEntry> amounts;
+    std::unordered_map<std::string_view, std::vector<uint32_t>> postings;
+};
+
+#endif /*!_BIDINDEX_HPP_*/
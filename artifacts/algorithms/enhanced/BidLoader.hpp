@@ -0,0 +1,312 @@
+//============================================================================
+// Name        : BidLoader.hpp
+// Description : Pipelined CSV load: file reads, tokenizing and Bid building overlap
+//============================================================================
+
+#ifndef _BIDLOADER_HPP_
+#define _BIDLOADER_HPP_
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "Bid.hpp"
+#include "CSVparser.hpp"
+#include "SpscQueue.hpp"
+
+/**
+ * Busy time of each load stage, excluding time spent waiting on the queues
+ * between them, and the wall time of the whole load
+ */
+struct LoadTimings {
+    double readMs = 0.0;        // file reads
+    double tokenizeMs = 0.0;    // record and field boundaries
+    double buildMs = 0.0;       // Bid construction and text copies
+    double totalMs = 0.0;       // first read to last bid
+    size_t bytes = 0;
+    size_t chunks = 0;
+};
+
+/**
+ * Loads the bids of a CSV export through a three-stage pipeline:
+ *
+ *   reader thread     reads fixed-size chunks of the file
+ *   tokenizer thread  indexes the records of each chunk with csv::Tokenizer,
+ *                     splitting a chunk across threads at quote-aware
+ *                     record boundaries when there are cores to spare
+ *   calling thread    builds Bids from the indexed fields into the arena
+ *
+ * Consecutive stages are linked by SpscQueues of full buffers, and return
+ * the emptied buffers through a second queue each way, so the pipeline
+ * holds a fixed number of buffers however large the file is. With a core
+ * per stage the wall time approaches that of the slowest stage instead of
+ * the sum of all three.
+ *
+ * A record cut by the end of a chunk is carried over by the tokenizer and
+ * indexed in front of the next chunk. Only the title, id, winning bid and
+ * fund columns are indexed.
+ *
+ * Tokenizing is the costliest stage, so with more than one indexing
+ * thread the chunks grow to a megabyte per thread (up to MAX_CHUNK):
+ * csv::Tokenizer gives each thread at least a megabyte, and would not
+ * split a smaller chunk at all.
+ */
+class BidLoader {
+public:
+    static const size_t MAX_CHUNK = 8 << 20;
+
+    /**
+     * @param csvPath File to load
+     * @param arena Arena that takes ownership of the bid text
+     * @param timings Receives the per-stage timings
+     * @param chunkSize Bytes per file read, at least
+     * @param depth Buffers in flight between each pair of stages
+     * @param threads Indexing threads, 0 for one per core
+     * @return Bids in file order
+     * @throws csv::Error if the file cannot be opened or is malformed
+     */
+    static std::vector<Bid> load(const std::string& csvPath, BidArena& arena, LoadTimings& timings,
+                                 size_t chunkSize = 1 << 18, size_t depth = 4, unsigned int threads = 0) {
+        std::vector<Bid> bids;
+        std::error_code sizeError;
+        auto fileSize = std::filesystem::file_size(csvPath, sizeError);
+        if (!sizeError) {
+            // Export rows run well over 128 bytes, so this over-reserves a little
+            bids.reserve(static_cast<size_t>(fileSize / 128));
+        }
+        stream(csvPath, timings, [&](const csv::RowView& row) {
+            build(row, arena, bids.emplace_back());
+        }, chunkSize, depth, threads);
+        return bids;
+    }
+
+    /**
+     * Runs the pipeline with sink(row) as the last stage, called on the
+     * calling thread for each record in file order. The row's fields are
+     * only valid during the call. buildMs is the time spent in the sink.
+     *
+     * @throws csv::Error if the file cannot be opened or is malformed, and
+     *         whatever the sink throws
+     */
+    template<typename Sink>
+    static void stream(const std::string& csvPath, LoadTimings& timings, Sink&& sink,
+                       size_t chunkSize = 1 << 18, size_t depth = 4, unsigned int threads = 0) {
+        typedef std::chrono::steady_clock Clock;
+        auto started = Clock::now();
+        timings = LoadTimings();
+        if (threads == 0) {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        if (threads > 1) {
+            chunkSize = std::max<size_t>(chunkSize, std::min<size_t>(static_cast<size_t>(threads) << 20, MAX_CHUNK));
+        }
+        chunkSize = std::max<size_t>(chunkSize, 4096);
+        depth = std::max<size_t>(depth, 1);
+
+        std::ifstream file(csvPath, std::ios::in | std::ios::binary);
+        if (!file.is_open()) {
+            throw csv::Error("Failed to open " + csvPath);
+        }
+
+        csv::Options options;
+        options.threads = threads;
+        options.select(0).select(1).select(4).select(8);
+        csv::Tokenizer tokenizer(',', options);
+
+        // Every buffer the stages pass around; the queues only carry pointers
+        std::vector<std::unique_ptr<Chunk>> chunks;
+        std::vector<std::unique_ptr<Batch>> batches;
+        SpscQueue<Chunk*> freeChunks(depth), fullChunks(depth);
+        SpscQueue<Batch*> freeBatches(depth), fullBatches(depth);
+        for (size_t i = 0; i < depth; ++i) {
+            chunks.emplace_back(new Chunk());
+            chunks.back()->data.resize(chunkSize);
+            freeChunks.tryPush(chunks.back().get());
+            batches.emplace_back(new Batch());
+            freeBatches.tryPush(batches.back().get());
+        }
+
+        auto cancelAll = [&]() {
+            freeChunks.cancel();
+            fullChunks.cancel();
+            freeBatches.cancel();
+            fullBatches.cancel();
+        };
+        std::exception_ptr readError, tokenizeError;
+
+        std::thread reader([&]() {
+            try {
+                Chunk* chunk;
+                while (freeChunks.pop(chunk)) {
+                    auto start = Clock::now();
+                    file.read(chunk->data.data(), static_cast<std::streamsize>(chunk->data.size()));
+                    chunk->size = static_cast<size_t>(file.gcount());
+                    timings.readMs += elapsedMs(start);
+                    timings.bytes += chunk->size;
+                    ++timings.chunks;
+                    if (chunk->size == 0 || !fullChunks.push(chunk)) {
+                        break;
+                    }
+                    if (!file) {
+                        break;
+                    }
+                }
+            }
+            catch (...) {
+                readError = std::current_exception();
+                cancelAll();
+            }
+            fullChunks.close();
+        });
+
+        std::thread indexer([&]() {
+            try {
+                tokenize(csvPath, tokenizer, freeChunks, fullChunks, freeBatches, fullBatches, timings.tokenizeMs);
+            }
+            catch (...) {
+                tokenizeError = std::current_exception();
+                cancelAll();
+            }
+            fullBatches.close();
+        });
+
+        std::exception_ptr buildError;
+        try {
+            Batch* batch;
+            unsigned int stride = 0;
+            while (fullBatches.pop(batch)) {
+                auto start = Clock::now();
+                if (stride == 0) {
+                    // The header is set before the first batch is queued
+                    stride = tokenizer.stride();
+                }
+                for (unsigned int r = 0; r < batch->rows; ++r) {
+                    sink(tokenizer.row(&batch->fields[static_cast<size_t>(r) * stride]));
+                }
+                timings.buildMs += elapsedMs(start);
+                if (!freeBatches.push(batch)) {
+                    break;
+                }
+            }
+        }
+        catch (...) {
+            buildError = std::current_exception();
+            cancelAll();
+        }
+
+        reader.join();
+        indexer.join();
+        for (std::exception_ptr error : { readError, tokenizeError, buildError }) {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+        timings.totalMs = elapsedMs(started);
+    }
+
+    /**
+     * Fills bid from an indexed record, copying its text into the arena
+     */
+    static void build(const csv::RowView& row, BidArena& arena, Bid& bid) {
+        bid.bidId = arena.copy(row[1]);
+        bid.title = arena.copy(row[0]);
+        bid.fund = arena.intern(row[8]);
+        if (csv::toNumber(row[4], bid.amount) != csv::eNUMBER_OK) {
+            bid.amount = 0.0;
+        }
+    }
+
+private:
+    struct Chunk {
+        std::vector<char> data;
+        size_t size = 0;
+    };
+
+    struct Batch {
+        std::vector<char> text;                 // carried-over record start, then a whole chunk
+        std::vector<std::string_view> fields;   // tokenizer.stride() per record, into text
+        unsigned int rows = 0;
+    };
+
+    static double elapsedMs(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    /**
+     * Tokenizer stage: copies each chunk into a batch, behind whatever
+     * partial record the previous chunk ended with, and indexes the
+     * records; the first non-blank line is taken as the header
+     */
+    static void tokenize(const std::string& csvPath, csv::Tokenizer& tokenizer,
+                         SpscQueue<Chunk*>& freeChunks, SpscQueue<Chunk*>& fullChunks,
+                         SpscQueue<Batch*>& freeBatches, SpscQueue<Batch*>& fullBatches, double& busyMs) {
+        std::vector<char> carry;
+        bool headerRead = false;
+        bool more = true;
+
+        while (more) {
+            Chunk* chunk = nullptr;
+            Batch* batch;
+            more = fullChunks.pop(chunk);
+            if (!freeBatches.pop(batch)) {
+                return;
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            batch->text.assign(carry.begin(), carry.end());
+            if (more) {
+                batch->text.insert(batch->text.end(), chunk->data.begin(), chunk->data.begin() + chunk->size);
+                freeChunks.push(chunk);
+            }
+            const char* begin = batch->text.data();
+            const char* end = begin + batch->text.size();
+
+            while (!headerRead) {
+                const char* newline = std::find(begin, end, '\n');
+                if (newline == end && more) {
+                    break;
+                }
+                std::string line(begin, newline);
+                begin = (newline == end) ? end : newline + 1;
+                if (!line.empty() && line != "\r") {
+                    tokenizer.setHeader(line);
+                    headerRead = true;
+                }
+                else if (newline == end) {
+                    throw csv::Error("No Data in " + csvPath);
+                }
+            }
+
+            batch->fields.clear();
+            batch->rows = 0;
+            if (!headerRead) {
+                carry.assign(begin, end);
+            }
+            else if (more) {
+                const char* complete = begin;
+                batch->rows = tokenizer.index(begin, end, batch->fields, &complete);
+                carry.assign(complete, end);
+            }
+            else {
+                batch->rows = tokenizer.index(begin, end, batch->fields);
+            }
+            busyMs += elapsedMs(start);
+
+            // A batch without records still goes through, to keep the buffer in circulation
+            if (!fullBatches.push(batch)) {
+                return;
+            }
+        }
+    }
+};
+
+#endif /*!_BIDLOADER_HPP_*/
@@ -0,0 +1,209 @@
+//============================================================================
+// Name        : BidSession.hpp
+// Description : Working set of bids that remembers whether, and how, it is sorted
+//============================================================================
+
+#ifndef _BIDSESSION_HPP_
+#define _BIDSESSION_HPP_
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "Bid.hpp"
+#include "BidIndex.hpp"
+#include "BidSorter.hpp"
+#include "SortSpec.hpp"
+
+/**
+ * The bids being worked on, the arena owning their text, the session sort
+ * order and whether the bids are currently in that order
+ *
+ * While the bids are sorted, inserts keep them sorted: a single bid goes
+ * in at its binary-searched position (O(log n) comparisons plus one shift)
+ * and a batch is sorted on its own and merged in, so adding to a sorted
+ * set never needs a full re-sort.
+ *
+ * The session also keeps a BidIndex over the same bids: rebuilt by
+ * assign(), extended by insert() and dropped by clear().
+ *
+ * isModified() tells whether bids were inserted since the last assign(),
+ * i.e. whether the bids (in whatever order) are still exactly the ones
+ * assigned, such as the rows of a loaded file.
+ */
+class BidSession {
+public:
+    BidSession() : sorted(true), modified(false) {}
+
+    BidSession(const BidSession&) = delete;
+    BidSession& operator=(const BidSession&) = delete;
+
+    const std::vector<Bid>& bids() const { return items; }
+    size_t size() const { return items.size(); }
+    bool empty() const { return items.empty(); }
+
+    /**
+     * @return Arena new bid text must be stored in to live as long as the bids
+     */
+    BidArena& arena() { return text; }
+
+    const SortSpec& sortSpec() const { return spec; }
+
+    /**
+     * @return Id, fund and amount lookups over the current bids
+     */
+    const BidIndex& index() const { return lookup; }
+
+    /**
+     * @return true if the bids are known to be in sortSpec() order
+     */
+    bool isSorted() const { return sorted; }
+
+    /**
+     * @return true if bids were inserted since the last assign() or clear()
+     */
+    bool isModified() const { return modified; }
+
+    /**
+     * Drops every bid and releases the text they point into
+     */
+    void clear() {
+        items.clear();
+        lookup.clear();
+        text.release();
+        sorted = true;
+        modified = false;
+    }
+
+    /**
+     * Replaces the bids, e.g. with a fresh load; their text must already
+     * be in arena(). The new bids are treated as unsorted and indexed
+     * from scratch.
+     *
+     * @param loaded New contents
+     */
+    void assign(std::vector<Bid> loaded) {
+        items = std::move(loaded);
+        lookup.build(items);
+        sorted = items.size() < 2;
+        modified = false;
+    }
+
+    /**
+     * Replaces the bids with ones already in the given order, e.g. a
+     * snapshot saved sorted; their text must already be in arena()
+     *
+     * @param loaded New contents, sorted by order
+     * @param order Order the bids are in, which becomes the session order
+     */
+    void assign(std::vector<Bid> loaded, const SortSpec& order) {
+        items = std::move(loaded);
+        lookup.build(items);
+        spec = order;
+        sorted = true;
+        modified = false;
+    }
+
+    /**
+     * Changes the session order; the bids count as sorted again only once
+     * sorted by the new order
+     *
+     * @param order New sort order
+     */
+    void setSortSpec(const SortSpec& order) {
+        if (order.str() != spec.str()) {
+            spec = order;
+            sorted = items.size() < 2;
+        }
+    }
+
+    /**
+     * Sorts the bids with algorithm(bids, sortSpec()). The bids only count
+     * as sorted if they then really are in sortSpec() order (one O(n)
+     * check), so an algorithm that leaves some other order cannot mislead
+     * insert() or a snapshot save.
+     *
+     * @param algorithm Any sort over vector<Bid> taking a SortSpec
+     * @return isSorted()
+     */
+    template<typename Algorithm>
+    bool sort(Algorithm algorithm) {
+        algorithm(items, spec);
+        sorted = withLess([&](auto less) { return std::is_sorted(items.begin(), items.end(), less); });
+        return sorted;
+    }
+
+    /**
+     * Adds one bid, at its sorted position if the bids are sorted (after
+     * any equal bids, so insertion order breaks ties as a stable sort would)
+     *
+     * @param bid Bid whose text lives in arena()
+     * @return Index the bid was stored at
+     */
+    size_t insert(const Bid& bid) {
+        lookup.insert(bid);
+        modified = true;
+        if (!sorted) {
+            items.push_back(bid);
+            return items.size() - 1;
+        }
+        size_t position = withLess([&](auto less) {
+            return static_cast<size_t>(std::upper_bound(items.begin(), items.end(), bid, less) - items.begin());
+        });
+        items.insert(items.begin() + position, bid);
+        return position;
+    }
+
+    /**
+     * Adds a batch of bids. If the bids are sorted, the batch is sorted on
+     * its own (stable, so O(k) when it arrives in order) and merged in from
+     * the back in one O(n + k) pass.
+     *
+     * @param batch Bids whose text lives in arena()
+     */
+    void insert(std::vector<Bid> batch) {
+        lookup.insert(batch);
+        modified = modified || !batch.empty();
+        if (!sorted) {
+            items.insert(items.end(), batch.begin(), batch.end());
+            return;
+        }
+        withLess([&](auto less) {
+            BidSorter::timSortBy(batch, less);
+
+            size_t old = items.size();
+            items.resize(old + batch.size());
+
+            // Largest first from the back; on ties the batch bid goes last
+            size_t i = old, j = batch.size(), dest = items.size();
+            while (j > 0) {
+                if (i > 0 && less(batch[j - 1], items[i - 1])) {
+                    items[--dest] = items[--i];
+                }
+                else {
+                    items[--dest] = batch[--j];
+                }
+            }
+            return 0;
+        });
+    }
+
+private:
+    /**
+     * Calls f(less) with the comparator for the session order, as
+     * BidSorter::withLess picks it
+     */
+    template<typename F>
+    auto withLess(F f) const -> decltype(f(BidSorter::TitleLess())) {
+        return BidSorter::withLess(spec, f);
+    }
+
+    BidArena text;
+    std::vector<Bid> items;
+    BidIndex lookup;
+    SortSpec spec;
+    bool sorted;
+    bool modified;
+};
+
+#endif /*!_BIDSESSION_HPP_*/
@@ -0,0 +1,286 @@
+//============================================================================
+// Name        : BidSnapshot.hpp
+// Description : Binary snapshot of a bid session, to skip re-parsing the CSV
+//============================================================================
+
+#ifndef _BIDSNAPSHOT_HPP_
+#define _BIDSNAPSHOT_HPP_
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+
+#include "Bid.hpp"
+#include "BidSession.hpp"
+#include "CSVparser.hpp"
+#include "SortSpec.hpp"
+
+/**
+ * Reads and writes session snapshots: the parsed bids of one CSV file in a
+ * form that loads with a single mapping and no parsing
+ *
+ * Layout, in host byte order (a snapshot is a local cache, not an
+ * interchange format):
+ *
+ *   Header       magic, version, the size and checksum of the source CSV,
+ *                row and text sizes, and the sort order if the rows are
+ *                stored sorted
+ *   Row[rows]    offset and length of each text field, and the amount
+ *   char[text]   every id and title, and each distinct fund once
+ *
+ * Rows are stored in the session's current order, so a snapshot of sorted
+ * bids restores them sorted. Loading maps the file and points the bids
+ * into its text block, so no text is read or copied up front; the session
+ * arena adopts the mapping, which lives until the session is cleared.
+ */
+class BidSnapshot {
+public:
+    static const uint32_t VERSION = 1;
+
+    /**
+     * @return Where the snapshot of csvPath is kept
+     */
+    static std::string pathFor(const std::string& csvPath) {
+        return csvPath + ".bidsnap";
+    }
+
+    /**
+     * Change-detection checksum: FNV-1a over 64-bit words with a fold, so
+     * a multi-megabyte export hashes in well under a millisecond. Not
+     * meant to resist deliberate collisions.
+     */
+    static uint64_t checksum(std::string_view bytes) {
+        const uint64_t prime = 0x100000001b3ULL;
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        size_t i = 0;
+        for (; i + 8 <= bytes.size(); i += 8) {
+            uint64_t word;
+            std::memcpy(&word, bytes.data() + i, sizeof(word));
+            hash = (hash ^ word) * prime;
+            hash ^= hash >> 29;
+        }
+        for (; i < bytes.size(); ++i) {
+            hash = (hash ^ static_cast<unsigned char>(bytes[i])) * prime;
+        }
+        return hash;
+    }
+
+    /**
+     * @return true if snapshotPath holds a readable snapshot, written no
+     *         earlier than csvPath was last modified, of exactly the bytes
+     *         csvPath holds now
+     */
+    static bool isFresh(const std::string& snapshotPath, const std::string& csvPath) {
+        std::error_code error;
+        auto snapshotTime = std::filesystem::last_write_time(snapshotPath, error);
+        if (error) return false;
+        auto csvTime = std::filesystem::last_write_time(csvPath, error);
+        if (error || snapshotTime < csvTime) return false;
+
+        try {
+            Header header;
+            std::ifstream in(snapshotPath, std::ios::binary);
+            if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) || !header.valid()) {
+                return false;
+            }
+            csv::MappedFile source(csvPath);
+            return header.sourceSize == source.size() && header.sourceChecksum == checksum(source.view());
+        }
+        catch (const std::exception&) {
+            return false;
+        }
+    }
+
+    /**
+     * Writes the session's bids, in their current order, as a snapshot of
+     * csvPath. The file is written beside its destination and renamed over
+     * it, so a failed save never leaves a truncated snapshot behind.
+     *
+     * A snapshot stands in for parsing the CSV, so it must hold exactly the
+     * bids the CSV does: a session with inserted bids is refused.
+     *
+     * @param snapshotPath File to write
+     * @param session Bids to save; their order is saved if they are sorted
+     * @param csvPath CSV file the bids were loaded from
+     * @throws std::runtime_error if the session was modified or the
+     *         snapshot cannot be written
+     */
+    static void save(const std::string& snapshotPath, const BidSession& session, const std::string& csvPath) {
+        if (session.isModified()) {
+            throw std::runtime_error("bids were added since " + csvPath + " was loaded");
+        }
+        const std::vector<Bid>& bids = session.bids();
+
+        Header header = Header::empty();
+        {
+            csv::MappedFile source(csvPath);
+            header.sourceSize = source.size();
+            header.sourceChecksum = checksum(source.view());
+        }
+        header.rows = bids.size();
+        if (session.isSorted()) {
+            std::string order = session.sortSpec().str();
+            if (order.size() < sizeof(header.sortOrder)) {
+                std::memcpy(header.sortOrder, order.data(), order.size());
+            }
+        }
+
+        std::string text;
+        std::vector<Row> rows(bids.size());
+        std::unordered_map<std::string_view, Field> funds;
+        for (size_t i = 0; i < bids.size(); ++i) {
+            rows[i].bidId = append(text, bids[i].bidId);
+            rows[i].title = append(text, bids[i].title);
+            auto fund = funds.find(bids[i].fund);
+            if (fund == funds.end()) {
+                fund = funds.emplace(bids[i].fund, append(text, bids[i].fund)).first;
+            }
+            rows[i].fund = fund->second;
+            rows[i].amount = bids[i].amount;
+        }
+        header.textBytes = text.size();
+
+        std::string temporary = snapshotPath + ".tmp";
+        {
+            std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            out.write(reinterpret_cast<const char*>(rows.data()), static_cast<std::streamsize>(rows.size() * sizeof(Row)));
+            out.write(text.data(), static_cast<std::streamsize>(text.size()));
+            if (!out.flush()) {
+                std::remove(temporary.c_str());
+                throw std::runtime_error("cannot write " + temporary);
+            }
+        }
+        std::error_code error;
+        std::filesystem::rename(temporary, snapshotPath, error);
+        if (error) {
+            std::remove(temporary.c_str());
+            throw std::runtime_error("cannot replace " + snapshotPath + ": " + error.message());
+        }
+    }
+
+    /**
+     * Replaces the session's bids with a snapshot's, their text left in the
+     * mapped file. The session comes back sorted (in the saved order) if it
+     * was saved sorted.
+     *
+     * @param snapshotPath File written by save()
+     * @param session Session to fill; cleared first
+     * @throws std::runtime_error if the file is not a valid snapshot
+     * @throws csv::Error if the file cannot be mapped
+     */
+    static void load(const std::string& snapshotPath, BidSession& session) {
+        auto file = std::make_shared<const csv::MappedFile>(snapshotPath);
+        if (file->size() < sizeof(Header)) {
+            throw std::runtime_error(snapshotPath + " is not a bid snapshot");
+        }
+        Header header;
+        std::memcpy(&header, file->data(), sizeof(header));
+        if (!header.valid()) {
+            throw std::runtime_error(snapshotPath + " is not a version " + std::to_string(VERSION) + " bid snapshot");
+        }
+        // Compared by subtraction, which the rows check keeps from
+        // underflowing, so a corrupt textBytes cannot wrap the sum around
+        if (header.rows > (file->size() - sizeof(Header)) / sizeof(Row) ||
+            header.textBytes != file->size() - sizeof(Header) - header.rows * sizeof(Row)) {
+            throw std::runtime_error(snapshotPath + " is truncated");
+        }
+
+        const char* rowData = file->data() + sizeof(Header);
+        std::string_view pool(rowData + header.rows * sizeof(Row), static_cast<size_t>(header.textBytes));
+
+        // Every row is checked before the session is touched, so a bad
+        // snapshot leaves it as it was
+        std::vector<Bid> bids(static_cast<size_t>(header.rows));
+        for (size_t i = 0; i < bids.size(); ++i) {
+            Row row;
+            std::memcpy(&row, rowData + i * sizeof(Row), sizeof(row));
+            bids[i].bidId = slice(pool, row.bidId);
+            bids[i].title = slice(pool, row.title);
+            bids[i].fund = slice(pool, row.fund);
+            bids[i].amount = row.amount;
+        }
+
+        size_t orderLength = 0;
+        while (orderLength < sizeof(header.sortOrder) && header.sortOrder[orderLength] != '\0') {
+            ++orderLength;
+        }
+        std::string order(header.sortOrder, orderLength);
+        SortSpec spec = order.empty() ? SortSpec() : SortSpec(order);
+
+        session.clear();
+        session.arena().adopt(std::move(file));
+        if (order.empty()) {
+            session.assign(std::move(bids));
+        }
+        else {
+            session.assign(std::move(bids), spec);
+        }
+    }
+
+private:
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t reserved;
+        uint64_t sourceSize;
+        uint64_t sourceChecksum;
+        uint64_t rows;
+        uint64_t textBytes;
+        char sortOrder[64];     // SortSpec::str() if the rows are sorted, else empty
+
+        static Header empty() {
+            Header header;
+            std::memset(&header, 0, sizeof(header));
+            std::memcpy(header.magic, "BIDSNAP", 8);
+            header.version = VERSION;
+            return header;
+        }
+
+        bool valid() const {
+            return std::memcmp(magic, "BIDSNAP", 8) == 0 && version == VERSION;
+        }
+    };
+
+    struct Field {
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    struct Row {
+        Field bidId;
+        Field title;
+        Field fund;
+        double amount;
+    };
+
+    static_assert(sizeof(Header) == 112, "snapshot header layout changed");
+    static_assert(sizeof(Row) == 32, "snapshot row layout changed");
+
+    static Field append(std::string& text, std::string_view value) {
+        if (text.size() + value.size() > UINT32_MAX) {
+            throw std::length_error("snapshot text exceeds 4 GiB");
+        }
+        Field field{ static_cast<uint32_t>(text.size()), static_cast<uint32_t>(value.size()) };
+        text.append(value.data(), value.size());
+        return field;
+    }
+
+    static std::string_view slice(std::string_view pool, Field field) {
+        if (field.offset > pool.size() || field.length > pool.size() - field.offset) {
+            throw std::runtime_error("snapshot field out of range");
+        }
+        return pool.substr(field.offset, field.length);
+    }
+};
+
+#endif /*!_BIDSNAPSHOT_HPP_*/
@@ -0,0 +1,1783 @@
+//============================================================================
+// Name        : BidSorter.hpp
+// Description : Sorting algorithms for Bid collections
+//============================================================================
+
+#ifndef _BIDSORTER_HPP_
+#define _BIDSORTER_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "Bid.hpp"
+#include "SortSpec.hpp"
+#include "ThreadPool.hpp"
+
+//============================================================================
+// Sorting Algorithms Class
+//============================================================================
+
+/**
+ * Class containing various sorting algorithms for Bid objects
+ * Provides modular, reusable sorting functionality with performance tracking
+ *
+ * Each algorithm is written once as a template over the element type and a
+ * "less" comparator (the ...By functions), so any order works: TitleLess,
+ * a compile-time FieldLess/ThenBy chain or a runtime SortSpec. The Bid
+ * overloads instantiate it with TitleLess, which inlines to the same title
+ * comparison the algorithms always used; the ...Table variants sort a
+ * permutation of BidTable rows,
+ * the ...Keyed variants sort compact (title prefix, row) keys, the
+ * parallel... variants fork subranges onto a work-stealing ThreadPool and
+ * the radix sorts key on bytes and bits instead of comparisons.
+ */
+class BidSorter {
+public:
+    /**
+     * Orders bids ascending by title
+     */
+    struct TitleLess {
+        bool operator()(const Bid& a, const Bid& b) const {
+            return a.title < b.title;
+        }
+    };
+
+    /**
+     * Calls f(less) with the fastest comparator for spec: TitleLess for
+     * plain title order, a ThenBy chain for the orders ops asks for most
+     * (amount:desc,fund,title, amount:desc,title and fund,title), which
+     * inlines with no per-key switch, and the SortSpec itself otherwise.
+     * Each order listed here is one more instantiation of every algorithm
+     * f sorts with, so the list stays short.
+     */
+    template<typename F>
+    static auto withLess(const SortSpec& spec, F f) -> decltype(f(spec)) {
+        typedef FieldLess<eAMOUNT, true> AmountDesc;
+        typedef FieldLess<eFUND> Fund;
+        typedef FieldLess<eTITLE> Title;
+        if (spec.isTitleOnly()) {
+            return f(TitleLess());
+        }
+        if (spec.matches<AmountDesc, Fund, Title>()) {
+            return f(ThenBy<AmountDesc, Fund, Title>());
+        }
+        if (spec.matches<AmountDesc, Title>()) {
+            return f(ThenBy<AmountDesc, Title>());
+        }
+        if (spec.matches<Fund, Title>()) {
+            return f(ThenBy<Fund, Title>());
+        }
+        return f(spec);
+    }
+
+    /**
+     * Orders row indices of a BidTable ascending by title
+     */
+    struct TableTitleLess {
+        const BidTable* table;
+
+        explicit TableTitleLess(const BidTable& t) : table(&t) {}
+
+        bool operator()(uint32_t a, uint32_t b) const {
+            return table->title(a) < table->title(b);
+        }
+    };
+
+    /**
+     * Orders row indices of a BidTable with any Bid comparator
+     */
+    template<typename Less>
+    struct TableLess {
+        const BidTable* table;
+        Less less;
+
+        TableLess(const BidTable& t, Less l) : table(&t), less(l) {}
+
+        bool operator()(uint32_t a, uint32_t b) const {
+            return less(table->toBid(a), table->toBid(b));
+        }
+    };
+
+    /**
+     * Sort key for one bid: an order-preserving 8-byte encoding of the
+     * first sort field (for text, its first 8 bytes big-endian and
+     * zero-padded), plus the bid's row in the source vector
+     */
+    struct SortKey {
+        uint64_t prefix;
+        uint32_t row;
+    };
+
+    /**
+     * Orders keys by prefix; the bids themselves are compared with less
+     * only on a prefix tie
+     */
+    template<typename Less = TitleLess>
+    struct KeyLess {
+        const std::vector<Bid>* bids;
+        Less less;
+
+        explicit KeyLess(const std::vector<Bid>& b, Less l = Less()) : bids(&b), less(l) {}
+
+        bool operator()(const SortKey& a, const SortKey& b) const {
+            if (a.prefix != b.prefix) {
+                return a.prefix < b.prefix;
+            }
+            return less((*bids)[a.row], (*bids)[b.row]);
+        }
+    };
+
+private:
+    /**
+     * Partition function for quicksort algorithm
+     * Divides the vector into two parts around a pivot element
+     *
+     * @param items Reference to vector of elements to partition
+     * @param begin Starting index for partition
+     * @param end Ending index for partition
+     * @param less Comparator defining the order
+     * @return Index of the partition point
+     */
+    template<typename T, typename Less>
+    static size_t partition(std::vector<T>& items, size_t begin, size_t end, Less less) {
+        if (begin >= end) return begin;
+
+        size_t lowIndex = begin;
+        size_t highIndex = end;
+
+        // Use middle element as pivot to improve average case performance
+        size_t middlePoint = lowIndex + (highIndex - lowIndex) / 2;
+        T pivot = items[middlePoint];   // a copy: its slot still takes part in the scan
+
+        while (true) {
+            // Find element greater than or equal to pivot from left
+            while (lowIndex <= end && less(items[lowIndex], pivot)) {
+                lowIndex++;
+            }
+
+            // Find element less than or equal to pivot from right
+            while (highIndex >= begin && less(pivot, items[highIndex])) {
+                highIndex--;
+            }
+
+            // If pointers have crossed, partitioning is complete
+            if (highIndex <= lowIndex) {
+                return highIndex;
+            }
+
+            // Swap elements and continue
+            std::swap(items[lowIndex], items[highIndex]);
+            lowIndex++;
+            highIndex--;
+        }
+    }
+
+    /**
+     * Merge function for merge sort algorithm
+     * Combines two sorted subarrays into a single sorted array
+     *
+     * @param items Reference to vector of elements
+     * @param left Starting index of left subarray
+     * @param mid Ending index of left subarray
+     * @param right Ending index of right subarray
+     * @param less Comparator defining the order
+     */
+    template<typename T, typename Less>
+    static void merge(std::vector<T>& items, size_t left, size_t mid, size_t right, Less less) {
+        // Move the left and right subarrays out into temporary arrays
+        std::vector<T> leftArray(std::make_move_iterator(items.begin() + left),
+            std::make_move_iterator(items.begin() + mid + 1));
+        std::vector<T> rightArray(std::make_move_iterator(items.begin() + mid + 1),
+            std::make_move_iterator(items.begin() + right + 1));
+
+        size_t i = 0, j = 0, k = left;
+
+        // Merge the temporary arrays back into items[left..right]
+        while (i < leftArray.size() && j < rightArray.size()) {
+            if (!less(rightArray[j], leftArray[i])) {
+                items[k] = std::move(leftArray[i]);
+                i++;
+            }
+            else {
+                items[k] = std::move(rightArray[j]);
+                j++;
+            }
+            k++;
+        }
+
+        // Move remaining elements of leftArray, if any
+        while (i < leftArray.size()) {
+            items[k] = std::move(leftArray[i]);
+            i++;
+            k++;
+        }
+
+        // Move remaining elements of rightArray, if any
+        while (j < rightArray.size()) {
+            items[k] = std::move(rightArray[j]);
+            j++;
+            k++;
+        }
+    }
+
+    /**
+     * Insertion sort of items[begin, end), moving elements; stable
+     *
+     * @param items Reference to vector of elements
+     * @param begin First index of the range
+     * @param end One past the last index of the range
+     * @param less Comparator defining the order
+     */
+    template<typename T, typename Less>
+    static void insertionSort(std::vector<T>& items, size_t begin, size_t end, Less less) {
+        for (size_t i = begin + 1; i < end; ++i) {
+            if (!less(items[i], items[i - 1])) {
+                continue;
+            }
+            T value = std::move(items[i]);
+            size_t j = i;
+            do {
+                items[j] = std::move(items[j - 1]);
+                --j;
+            } while (j > begin && less(value, items[j - 1]));
+            items[j] = std::move(value);
+        }
+    }
+
+    /**
+     * Moves the stable merge of from[left, mid) and from[mid, right) into
+     * to[left, right)
+     */
+    template<typename T, typename Less>
+    static void mergeMove(std::vector<T>& from, std::vector<T>& to, size_t left, size_t mid, size_t right, Less less) {
+        size_t i = left, j = mid, k = left;
+        while (i < mid && j < right) {
+            if (!less(from[j], from[i])) {
+                to[k++] = std::move(from[i++]);
+            }
+            else {
+                to[k++] = std::move(from[j++]);
+            }
+        }
+        std::move(from.begin() + i, from.begin() + mid, to.begin() + k);
+        std::move(from.begin() + j, from.begin() + right, to.begin() + k + (mid - i));
+    }
+
+    /**
+     * Sifts items[base + i] down a max-heap of the n elements starting at base
+     *
+     * The root is moved out and each larger child moved up into the hole
+     * it leaves, so a level costs one move instead of a three-move swap;
+     * the resulting heap is the same as swapping down would give.
+     *
+     * @param items Reference to vector of elements
+     * @param base Index of the heap's first element
+     * @param n Number of elements in the heap
+     * @param i Index of the subtree root, relative to base
+     * @param less Comparator defining the order
+     */
+    template<typename T, typename Less>
+    static void heapify(std::vector<T>& items, size_t base, size_t n, size_t i, Less less) {
+        if (2 * i + 1 >= n) return;
+        T root = std::move(items[base + i]);
+
+        while (2 * i + 1 < n) {
+            size_t largest = 2 * i + 1;    // left child
+            size_t right = largest + 1;    // right child
+
+            // If right child is larger than the left
+            if (right < n && less(items[base + largest], items[base + right])) {
+                largest = right;
+            }
+
+            // Stop once the root is no smaller than the larger child
+            if (!less(root, items[base + largest])) {
+                break;
+            }
+            items[base + i] = std::move(items[base + largest]);
+            i = largest;
+        }
+        items[base + i] = std::move(root);
+    }
+
+    /**
+     * Heap sort of items[begin, end)
+     */
+    template<typename T, typename Less>
+    static void heapSortRange(std::vector<T>& items, size_t begin, size_t end, Less less) {
+        size_t n = end - begin;
+        if (n < 2) return;
+
+        // Build heap (rearrange array)
+        for (size_t i = n / 2; i-- > 0;) {
+            heapify(items, begin, n, i, less);
+        }
+
+        // Extract elements from heap one by one
+        for (size_t i = n - 1; i > 0; i--) {
+            std::swap(items[begin], items[begin + i]);
+            heapify(items, begin, i, 0, less);
+        }
+    }
+
+    /**
+     * @return Index of the median of items[a], items[b] and items[c]
+     */
+    template<typename T, typename Less>
+    static size_t medianOfThree(const std::vector<T>& items, size_t a, size_t b, size_t c, Less less) {
+        if (less(items[a], items[b])) {
+            if (less(items[b], items[c])) return b;
+            return less(items[a], items[c]) ? c : a;
+        }
+        if (less(items[a], items[c])) return a;
+        return less(items[b], items[c]) ? c : b;
+    }
+
+    /**
+     * Picks a sampled median pivot and partitions [begin, end) around it
+     * (at least 2 elements)
+     *
+     * @return Split point p, begin < p <= end: nothing in [begin, p) is
+     *         greater than the pivot and nothing in [p, end) is less
+     */
+    template<typename T, typename Less>
+    static size_t partitionAroundPivot(std::vector<T>& items, size_t begin, size_t end, Less less) {
+        // Median of three for small ranges, Tukey's ninther for large ones
+        size_t n = end - begin;
+        size_t mid = begin + n / 2;
+        size_t pivot;
+        if (n > 128) {
+            size_t step = n / 8;
+            pivot = medianOfThree(items,
+                medianOfThree(items, begin + 1, begin + 1 + step, begin + 1 + 2 * step, less),
+                medianOfThree(items, mid - step, mid, mid + step, less),
+                medianOfThree(items, end - 1 - 2 * step, end - 1 - step, end - 1, less),
+                less);
+        }
+        else {
+            pivot = medianOfThree(items, begin + 1, mid, end - 1, less);
+        }
+
+        // Park the pivot in items[begin] and partition around it there,
+        // so it is compared by reference rather than copied. Sampled
+        // elements on both sides of the median stop each scan.
+        std::swap(items[begin], items[pivot]);
+        size_t low = begin + 1;
+        size_t high = end;
+        while (true) {
+            while (less(items[low], items[begin])) {
+                ++low;
+            }
+            --high;
+            while (less(items[begin], items[high])) {
+                --high;
+            }
+            if (low >= high) {
+                break;
+            }
+            std::swap(items[low], items[high]);
+            ++low;
+        }
+        return low;
+    }
+
+    /**
+     * Introsort loop over items[begin, end): quicksort with the pivot
+     * chosen in place, heap sort once depthLimit splits have been spent
+     */
+    template<typename T, typename Less>
+    static void introSortRange(std::vector<T>& items, size_t begin, size_t end, size_t depthLimit, Less less) {
+        const size_t insertionThreshold = 16;
+
+        while (end - begin > insertionThreshold) {
+            if (depthLimit == 0) {
+                // Too many unbalanced splits; finish with a guaranteed n log n
+                heapSortRange(items, begin, end, less);
+                return;
+            }
+            --depthLimit;
+
+            size_t low = partitionAroundPivot(items, begin, end, less);
+
+            // Recurse into the right side, loop on the left
+            introSortRange(items, low, end, depthLimit, less);
+            end = low;
+        }
+        insertionSort(items, begin, end, less);
+    }
+
+    /**
+     * Partial introsort loop over items[begin, end), which overlaps the
+     * wanted positions [first, last): each split only continues into the
+     * sides that still overlap them
+     */
+    template<typename T, typename Less>
+    static void partialSortRange(std::vector<T>& items, size_t begin, size_t end,
+                                 size_t first, size_t last, size_t depthLimit, Less less) {
+        const size_t insertionThreshold = 16;
+
+        while (end - begin > insertionThreshold) {
+            if (depthLimit == 0) {
+                heapSortRange(items, begin, end, less);
+                return;
+            }
+            --depthLimit;
+
+            size_t low = partitionAroundPivot(items, begin, end, less);
+
+            bool wantLeft = first < low;
+            bool wantRight = low < last;
+            if (wantLeft && wantRight) {
+                partialSortRange(items, low, end, first, last, depthLimit, less);
+                end = low;
+            }
+            else if (wantLeft) {
+                end = low;
+            }
+            else {
+                begin = low;
+            }
+        }
+        insertionSort(items, begin, end, less);
+    }
+
+public:
+    //========================================================================
+    // Generic algorithms
+    //========================================================================
+
+    /**
+     * Selection Sort over any element type and ordering
+     * Time Complexity: O(n^2) average and worst case
+     * Space Complexity: O(1)
+     */
+    template<typename T, typename Less>
+    static void selectionSortBy(std::vector<T>& items, Less less) {
+        if (items.empty()) return;
+
+        size_t size = items.size();
+
+        for (size_t i = 0; i < size - 1; ++i) {
+            size_t minIndex = i;
+
+            // Find the minimum element in remaining unsorted array
+            for (size_t j = i + 1; j < size; ++j) {
+                if (less(items[j], items[minIndex])) {
+                    minIndex = j;
+                }
+            }
+
+            // Swap the found minimum element with the first element
+            if (minIndex != i) {
+                std::swap(items[i], items[minIndex]);
+            }
+        }
+    }
+
+    /**
+     * Quick Sort over any element type and ordering (inclusive range)
+     * Time Complexity: O(n log n) average case, O(n^2) worst case
+     * Space Complexity: O(log n) average case due to recursion
+     */
+    template<typename T, typename Less>
+    static void quickSortBy(std::vector<T>& items, size_t begin, size_t end, Less less) {
+        if (items.empty() || end <= begin) return;
+
+        // Partition the array and get the pivot index
+        size_t pivotIndex = partition(items, begin, end, less);
+
+        // Recursively sort elements before and after partition
+        if (pivotIndex > begin) {
+            quickSortBy(items, begin, pivotIndex, less);
+        }
+        if (pivotIndex < end) {
+            quickSortBy(items, pivotIndex + 1, end, less);
+        }
+    }
+
+    /**
+     * Merge Sort over any element type and ordering (inclusive range)
+     * Time Complexity: O(n log n) guaranteed
+     * Space Complexity: O(n) for temporary arrays
+     */
+    template<typename T, typename Less>
+    static void mergeSortBy(std::vector<T>& items, size_t left, size_t right, Less less) {
+        if (items.empty() || left >= right) return;
+
+        // Find the middle point to divide the array into two halves
+        size_t mid = left + (right - left) / 2;
+
+        // Recursively sort first and second halves
+        mergeSortBy(items, left, mid, less);
+        mergeSortBy(items, mid + 1, right, less);
+
+        // Merge the sorted halves
+        merge(items, left, mid, right, less);
+    }
+
+    /**
+     * Buffered Merge Sort over any element type and ordering
+     * Bottom-up: runs of insertionRun elements are insertion-sorted in place,
+     * then merged pairwise, each pass moving everything from one buffer into
+     * the other. The only allocation is scratch, which a caller sorting
+     * repeatedly can keep and pass back in. Stable.
+     * Time Complexity: O(n log n) guaranteed
+     * Space Complexity: O(n) for the scratch buffer
+     *
+     * @param items Elements to sort
+     * @param scratch Work buffer; resized to items.size(), contents unspecified
+     *                afterwards (it may end up holding the original storage)
+     * @param less Comparator defining the order
+     */
+    template<typename T, typename Less>
+    static void bufferedMergeSortBy(std::vector<T>& items, std::vector<T>& scratch, Less less) {
+        const size_t insertionRun = 32;
+        size_t n = items.size();
+        if (n < 2) return;
+
+        for (size_t begin = 0; begin < n; begin += insertionRun) {
+            insertionSort(items, begin, std::min(begin + insertionRun, n), less);
+        }
+        if (n <= insertionRun) return;
+
+        scratch.resize(n);
+        std::vector<T>* from = &items;
+        std::vector<T>* to = &scratch;
+        for (size_t width = insertionRun; width < n; width *= 2) {
+            for (size_t left = 0; left < n; left += 2 * width) {
+                size_t mid = std::min(left + width, n);
+                size_t right = std::min(left + 2 * width, n);
+                mergeMove(*from, *to, left, mid, right, less);
+            }
+            std::swap(from, to);
+        }
+
+        // An odd number of passes leaves the result in scratch; trade storage
+        // rather than moving it back
+        if (from != &items) {
+            items.swap(scratch);
+        }
+    }
+
+    template<typename T, typename Less>
+    static void bufferedMergeSortBy(std::vector<T>& items, Less less) {
+        std::vector<T> scratch;
+        bufferedMergeSortBy(items, scratch, less);
+    }
+
+    /**
+     * Tim Sort over any element type and ordering
+     * Adaptive natural merge sort: finds the runs already in the data
+     * (reversing strictly descending ones), extends short runs to a minimum
+     * length with binary insertion sort, and merges them with galloping
+     * once one side keeps winning. Sorted or mostly sorted input, such as a
+     * re-export with new auctions appended, costs close to one linear pass.
+     * Stable.
+     * Time Complexity: O(n) best case, O(n log n) worst case
+     * Space Complexity: O(n) worst case for the merge buffer
+     */
+    template<typename T, typename Less>
+    static void timSortBy(std::vector<T>& items, Less less) {
+        if (items.size() < 2) return;
+        TimSortState<T, Less>(items, less).sort();
+    }
+
+    /**
+     * Heap Sort over any element type and ordering
+     * Time Complexity: O(n log n) guaranteed
+     * Space Complexity: O(1)
+     */
+    template<typename T, typename Less>
+    static void heapSortBy(std::vector<T>& items, Less less) {
+        if (items.empty()) return;
+
+        size_t n = items.size();
+
+        // Build heap (rearrange array)
+        for (size_t i = n / 2; i-- > 0;) {
+            heapify(items, 0, n, i, less);
+        }
+
+        // Extract elements from heap one by one
+        for (size_t i = n - 1; i > 0; i--) {
+            // Move current root to end
+            std::swap(items[0], items[i]);
+
+            // Call max heapify on the reduced heap
+            heapify(items, 0, i, 0, less);
+        }
+    }
+
+    /**
+     * Intro Sort over any element type and ordering
+     * Quicksort with a median-of-three (ninther above 128 elements) pivot,
+     * insertion sort on ranges of 16 or fewer, and a switch to heap sort
+     * for any range still splitting after 2*log2(n) levels, so sorted,
+     * reversed or adversarial input cannot degrade it to O(n^2).
+     * Time Complexity: O(n log n) guaranteed
+     * Space Complexity: O(log n) for recursion
+     */
+    template<typename T, typename Less>
+    static void introSortBy(std::vector<T>& items, Less less) {
+        introSortBy(items, 0, items.size(), less);
+    }
+
+    /**
+     * Intro Sort of items[begin, end)
+     */
+    template<typename T, typename Less>
+    static void introSortBy(std::vector<T>& items, size_t begin, size_t end, Less less) {
+        size_t depthLimit = 0;
+        for (size_t n = end - begin; n > 1; n >>= 1) {
+            depthLimit += 2;
+        }
+        if (end - begin > 1) {
+            introSortRange(items, begin, end, depthLimit, less);
+        }
+    }
+
+    /**
+     * Partial Quick Sort: afterwards items[first, last) holds, in order,
+     * exactly what a full sort would put there, with everything smaller
+     * before it and everything larger after it in no particular order.
+     * Partitions like introSortBy but only follows the sides overlapping
+     * [first, last), so a top-k (first = 0, last = k) or a page of ranks
+     * never sorts the other elements.
+     * Time Complexity: O(n + k log k) average for k = last - first,
+     *                  O(n log n) worst case
+     * Space Complexity: O(log n) for recursion
+     */
+    template<typename T, typename Less>
+    static void partialQuickSortBy(std::vector<T>& items, size_t first, size_t last, Less less) {
+        if (last > items.size()) last = items.size();
+        if (first >= last || items.size() < 2) return;
+
+        size_t depthLimit = 0;
+        for (size_t n = items.size(); n > 1; n >>= 1) {
+            depthLimit += 2;
+        }
+        partialSortRange(items, 0, items.size(), first, last, depthLimit, less);
+    }
+
+    /**
+     * Heap Top-K: the k smallest elements, in order, from one pass that
+     * keeps the best k seen so far in a max-heap (its root is the one to
+     * evict). items itself is not modified. Equal elements come out in no
+     * particular order.
+     * Time Complexity: O(n log k)
+     * Space Complexity: O(k)
+     */
+    template<typename T, typename Less>
+    static std::vector<T> topKBy(const std::vector<T>& items, size_t k, Less less) {
+        if (k > items.size()) k = items.size();
+        std::vector<T> best(items.begin(), items.begin() + k);
+        if (k == 0) return best;
+
+        for (size_t i = k / 2; i-- > 0;) {
+            heapify(best, 0, k, i, less);
+        }
+        for (size_t i = k; i < items.size(); ++i) {
+            if (less(items[i], best[0])) {
+                best[0] = items[i];
+                heapify(best, 0, k, 0, less);
+            }
+        }
+        heapSortRange(best, 0, k, less);
+        return best;
+    }
+
+    /**
+     * Parallel Quick Sort: partitions like quickSortBy, then forks the left
+     * side onto the pool while the calling thread sorts the right side.
+     * Ranges of at most cutoff elements are sorted sequentially.
+     * Time Complexity: O(n log n) average work, O(n) span for the partitions
+     * Space Complexity: O(log n) average case due to recursion
+     */
+    template<typename T, typename Less>
+    static void parallelQuickSortBy(std::vector<T>& items, Less less, ThreadPool& pool, size_t cutoff) {
+        if (items.size() < 2) return;
+        parallelQuickSortRange(items, 0, items.size() - 1, less, pool, cutoff);
+    }
+
+    /**
+     * Parallel Merge Sort: sorts both halves concurrently, then merges them
+     * with a parallel merge that splits the larger run at its median and
+     * binary-searches the split point in the other. Runs ping-pong between
+     * items and one scratch buffer, so nothing is copied back per level;
+     * ranges of up to cutoff elements are buffered-merge-sorted straight
+     * into the buffer their level merges from, and every element is moved,
+     * never copied. Stable, like mergeSortBy.
+     * Time Complexity: O(n log n) work, O(log^3 n) span
+     * Space Complexity: O(n) for the scratch buffer
+     */
+    template<typename T, typename Less>
+    static void parallelMergeSortBy(std::vector<T>& items, Less less, ThreadPool& pool, size_t cutoff) {
+        if (items.size() < 2) return;
+        std::vector<T> scratch(items.size());
+        parallelMergeSortRange(items, scratch, 0, items.size(), false, less, pool, cutoff);
+    }
+
+    //========================================================================
+    // Bid algorithms (ordered by title)
+    //========================================================================
+
+    /**
+     * Selection Sort Algorithm
+     * Time Complexity: O(n^2) average and worst case
+     * Space Complexity: O(1)
+     *
+     * @param bids Reference to vector of Bid objects to sort
+     */
+    static void selectionSort(std::vector<Bid>& bids) {
+        selectionSortBy(bids, TitleLess());
+    }
+
+    /**
+     * Quick Sort Algorithm (Recursive Implementation)
+     * Time Complexity: O(n log n) average case, O(n^2) worst case
+     * Space Complexity: O(log n) average case due to recursion
+     *
+     * @param bids Reference to vector of Bid objects to sort
+     * @param begin Starting index for sorting
+     * @param end Ending index for sorting
+     */
+    static void quickSort(std::vector<Bid>& bids, size_t begin, size_t end) {
+        quickSortBy(bids, begin, end, TitleLess());
+    }
+
+    /**
+     * Merge Sort Algorithm (Recursive Implementation)
+     * Time Complexity: O(n log n) guaranteed
+     * Space Complexity: O(n) for temporary arrays
+     *
+     * @param bids Reference to vector of Bid objects to sort
+     * @param left Starting index for sorting
+     * @param right Ending index for sorting
+     */
+    static void mergeSort(std::vector<Bid>& bids, size_t left, size_t right) {
+        mergeSortBy(bids, left, right, TitleLess());
+    }
+
+    /**
+     * Heap Sort Algorithm
+     * Time Complexity: O(n log n) guaranteed
+     * Space Complexity: O(1)
+     *
+     * @param bids Reference to vector of Bid objects to sort
+     */
+    static void heapSort(std::vector<Bid>& bids) {
+        heapSortBy(bids, TitleLess());
+    }
+
+    /**
+     * Intro Sort Algorithm (hybrid quicksort with a heap sort fallback)
+     * Time Complexity: O(n log n) guaranteed
+     * Space Complexity: O(log n) for recursion
+     *
+     * @param bids Reference to vector of Bid objects to sort
+     */
+    static void introSort(std::vector<Bid>& bids) {
+        introSortBy(bids, TitleLess());
+    }
+
+    /**
+     * Tim Sort Algorithm (adaptive, stable natural merge sort)
+     * Time Complexity: O(n) on sorted input, O(n log n) worst case
+     * Space Complexity: O(n) worst case
+     *
+     * @param bids Reference to vector of Bid objects to sort
+     */
+    static void timSort(std::vector<Bid>& bids) {
+        timSortBy(bids, TitleLess());
+    }
+
+    /**
+     * Buffered Merge Sort Algorithm (one scratch buffer, no per-merge copies)
+     * Time Complexity: O(n log n) guaranteed
+     * Space Complexity: O(n) for the scratch buffer
+     *
+     * @param bids Reference to vector of Bid objects to sort
+     */
+    static void bufferedMergeSort(std::vector<Bid>& bids) {
+        bufferedMergeSortBy(bids, TitleLess());
+    }
+
+    /**
+     * Parallel Quick Sort on the shared pool
+     *
+     * @param bids Reference to vector of Bid objects to sort
+     */
+    static void parallelQuickSort(std::vector<Bid>& bids) {
+        parallelQuickSortBy(bids, TitleLess(), ThreadPool::shared(), parallelCutoff());
+    }
+
+    /**
+     * Parallel Merge Sort on the shared pool
+     *
+     * @param bids Reference to vector of Bid objects to sort
+     */
+    static void parallelMergeSort(std::vector<Bid>& bids) {
+        parallelMergeSortBy(bids, TitleLess(), ThreadPool::shared(), parallelCutoff());
+    }
+
+    /**
+     * Ranges at or below this many elements are sorted (or merged) on one
+     * thread; forking smaller pieces costs more than it saves
+     */
+    static size_t parallelCutoff() {
+        return cutoffSetting().load();
+    }
+
+    static void setParallelCutoff(size_t elements) {
+        cutoffSetting().store(elements < 2 ? 2 : elements);
+    }
+
+    //========================================================================
+    // Radix algorithms
+    //========================================================================
+
+    /**
+     * Multikey Quick Sort (Bentley-Sedgewick three-way radix quicksort)
+     * Partitions on one byte of the first sort key at a time, so shared
+     * prefixes ("Lot of ...") are inspected once per level instead of once
+     * per comparison. Works for any text first key (title, id or fund, either
+     * direction); bids with equal first keys are ordered by the rest of the
+     * spec. An amount first key has no bytes to split, so introSort is used
+     * (see multikeyQuickSortApplies).
+     * Time Complexity: O(n log n + D), D = total distinguishing prefix bytes
+     * Space Complexity: O(n) for the keys
+     *
+     * @param bids Reference to vector of Bid objects to sort
+     * @param spec Order to sort by (title by default)
+     */
+    static void multikeyQuickSort(std::vector<Bid>& bids, const SortSpec& spec = SortSpec()) {
+        if (bids.size() < 2) return;
+        const SortKeySpec& first = spec[0];
+        if (first.field == eAMOUNT) {
+            withLess(spec, [&](auto less) { introSortBy(bids, less); });
+            return;
+        }
+
+        std::vector<TextKey> keys(bids.size());
+        for (size_t i = 0; i < bids.size(); ++i) {
+            std::string_view text = (first.field == eBID_ID) ? bids[i].bidId
+                : (first.field == eFUND) ? bids[i].fund : bids[i].title;
+            keys[i].data = text.data();
+            keys[i].size = static_cast<uint32_t>(text.size());
+            keys[i].row = static_cast<uint32_t>(i);
+        }
+        multikeyRange(keys, 0, keys.size(), 0, bids, spec.rest(), first.descending);
+        applyKeys(bids, keys);
+    }
+
+    /**
+     * @return true if multikeyQuickSort sorts spec by its own method rather
+     *         than handing it to introSort
+     */
+    static bool multikeyQuickSortApplies(const SortSpec& spec) {
+        return spec[0].field != eAMOUNT;
+    }
+
+    /**
+     * LSD Radix Sort on amount
+     * Amounts are mapped to order-preserving 64-bit integers and distributed
+     * one byte at a time, skipping bytes every key shares. Needs spec to
+     * start with amount (either direction); it is stable, so the rest of
+     * spec is honored by ordering on it first. Any other spec has no amount
+     * key to distribute on and is sorted with the (also stable) buffered
+     * merge sort instead (see radixSortApplies).
+     * Time Complexity: O(n) per byte, at most 8 passes; O(n log n) otherwise
+     * Space Complexity: O(n) for the keys and one buffer
+     *
+     * @param bids Reference to vector of Bid objects to sort
+     * @param spec Order to sort by (title by default)
+     */
+    static void radixSortByAmount(std::vector<Bid>& bids, const SortSpec& spec = SortSpec()) {
+        if (bids.size() < 2) return;
+        if (!radixSortApplies(spec)) {
+            withLess(spec, [&](auto less) { bufferedMergeSortBy(bids, less); });
+            return;
+        }
+        bool descending = spec[0].descending;
+        SortSpec tiebreak = spec.rest();
+        if (tiebreak.size() > 0) {
+            withLess(tiebreak, [&](auto less) { bufferedMergeSortBy(bids, less); });
+        }
+
+        std::vector<SortKey> keys = makeKeys(bids, SortKeySpec{ eAMOUNT, descending });
+        radixSortKeys(keys);
+        applyKeys(bids, keys);
+    }
+
+    /**
+     * @return true if radixSortByAmount radix sorts spec rather than
+     *         handing it to bufferedMergeSort
+     */
+    static bool radixSortApplies(const SortSpec& spec) {
+        return spec[0].field == eAMOUNT;
+    }
+
+    //========================================================================
+    // Selection algorithms (top-k and rank ranges)
+    //========================================================================
+
+    /**
+     * The first k bids of spec order, via the bounded heap of topKBy
+     * Time Complexity: O(n log k)
+     * Space Complexity: O(k)
+     *
+     * @param bids Bids to select from (left unchanged)
+     * @param k Number of bids wanted
+     * @param spec Order to rank by (title by default)
+     * @return min(k, bids.size()) bids in spec order
+     */
+    static std::vector<Bid> topK(const std::vector<Bid>& bids, size_t k, const SortSpec& spec = SortSpec()) {
+        return withLess(spec, [&](auto less) { return topKBy(bids, k, less); });
+    }
+
+    /**
+     * Sorts only ranks [first, last) of spec order into place, via
+     * partialQuickSortBy
+     * Time Complexity: O(n + k log k) average for k = last - first
+     * Space Complexity: O(log n) for recursion
+     *
+     * @param bids Reference to vector of Bid objects to rearrange
+     * @param first First wanted rank (0-based)
+     * @param last One past the last wanted rank
+     * @param spec Order to rank by (title by default)
+     */
+    static void partialQuickSort(std::vector<Bid>& bids, size_t first, size_t last, const SortSpec& spec = SortSpec()) {
+        withLess(spec, [&](auto less) { partialQuickSortBy(bids, first, last, less); });
+    }
+
+    //========================================================================
+    // Columnar algorithms (BidTable row permutations, ordered by title)
+    //========================================================================
+
+    /**
+     * Each sorts order, a permutation of the table's row indices, by spec
+     * (title by default). An order of the wrong size is reset to the
+     * identity first; the table itself is never modified. Use
+     * BidTable::toBids(order) to materialize.
+     */
+    static void selectionSortTable(const BidTable& table, std::vector<uint32_t>& order,
+        const SortSpec& spec = SortSpec()) {
+        sortTable(table, order, spec, [](std::vector<uint32_t>& rows, auto less) {
+            selectionSortBy(rows, less);
+        });
+    }
+
+    static void quickSortTable(const BidTable& table, std::vector<uint32_t>& order,
+        const SortSpec& spec = SortSpec()) {
+        sortTable(table, order, spec, [](std::vector<uint32_t>& rows, auto less) {
+            quickSortBy(rows, 0, rows.size() - 1, less);
+        });
+    }
+
+    static void mergeSortTable(const BidTable& table, std::vector<uint32_t>& order,
+        const SortSpec& spec = SortSpec()) {
+        sortTable(table, order, spec, [](std::vector<uint32_t>& rows, auto less) {
+            mergeSortBy(rows, 0, rows.size() - 1, less);
+        });
+    }
+
+    static void heapSortTable(const BidTable& table, std::vector<uint32_t>& order,
+        const SortSpec& spec = SortSpec()) {
+        sortTable(table, order, spec, [](std::vector<uint32_t>& rows, auto less) {
+            heapSortBy(rows, less);
+        });
+    }
+
+    //========================================================================
+    // Key-extraction algorithms (prefix keys, ordered by title)
+    //========================================================================
+
+    /**
+     * Each builds one SortKey per bid from the first field of spec (title
+     * by default), sorts the 16-byte keys with the named algorithm and then
+     * moves every bid exactly once into its final place. Comparisons are
+     * mostly a single integer compare, and the algorithms shuffle keys
+     * rather than whole Bid records.
+     */
+    static void selectionSortKeyed(std::vector<Bid>& bids, const SortSpec& spec = SortSpec()) {
+        sortKeyed(bids, spec, [](std::vector<SortKey>& keys, auto less) {
+            selectionSortBy(keys, less);
+        });
+    }
+
+    static void quickSortKeyed(std::vector<Bid>& bids, const SortSpec& spec = SortSpec()) {
+        sortKeyed(bids, spec, [](std::vector<SortKey>& keys, auto less) {
+            quickSortBy(keys, 0, keys.size() - 1, less);
+        });
+    }
+
+    static void mergeSortKeyed(std::vector<Bid>& bids, const SortSpec& spec = SortSpec()) {
+        sortKeyed(bids, spec, [](std::vector<SortKey>& keys, auto less) {
+            mergeSortBy(keys, 0, keys.size() - 1, less);
+        });
+    }
+
+    static void heapSortKeyed(std::vector<Bid>& bids, const SortSpec& spec = SortSpec()) {
+        sortKeyed(bids, spec, [](std::vector<SortKey>& keys, auto less) {
+            heapSortBy(keys, less);
+        });
+    }
+
+    /**
+     * @param title Text to encode
+     * @return First 8 bytes of title as a big-endian integer, zero-padded
+     */
+    static uint64_t titlePrefix(std::string_view title) {
+        uint64_t prefix = 0;
+        size_t n = (title.size() < 8) ? title.size() : 8;
+        for (size_t i = 0; i < n; ++i) {
+            prefix |= uint64_t(static_cast<unsigned char>(title[i])) << (56 - 8 * i);
+        }
+        return prefix;
+    }
+
+    /**
+     * @param bid Bid to encode
+     * @param key Sort field and direction
+     * @return Integer whose order matches the order key puts bids in
+     */
+    static uint64_t keyPrefix(const Bid& bid, const SortKeySpec& key) {
+        uint64_t prefix;
+        switch (key.field) {
+        case eBID_ID: prefix = titlePrefix(bid.bidId); break;
+        case eFUND:   prefix = titlePrefix(bid.fund); break;
+        case eAMOUNT: {
+            // IEEE-754 bits ordered as unsigned: flip negatives entirely and
+            // set the sign bit of positives (+0 and -0 both map to +0)
+            double amount = (bid.amount == 0.0) ? 0.0 : bid.amount;
+            std::memcpy(&prefix, &amount, sizeof(prefix));
+            prefix = (prefix & (uint64_t(1) << 63)) ? ~prefix : (prefix | (uint64_t(1) << 63));
+            break;
+        }
+        default:      prefix = titlePrefix(bid.title); break;
+        }
+        return key.descending ? ~prefix : prefix;
+    }
+
+private:
+    /**
+     * Working state of one Tim Sort: the pending run stack, the merge
+     * buffer and the adaptive galloping threshold
+     */
+    template<typename T, typename Less>
+    class TimSortState {
+    public:
+        TimSortState(std::vector<T>& items, Less less)
+            : a(items.data()), n(static_cast<std::ptrdiff_t>(items.size())), less(less), minGallop(MIN_GALLOP) {
+        }
+
+        void sort() {
+            if (n < MIN_MERGE) {
+                std::ptrdiff_t run = countRunAndMakeAscending(0, n);
+                binaryInsertionSort(0, n, run);
+                return;
+            }
+
+            std::ptrdiff_t minRun = minRunLength(n);
+            std::ptrdiff_t low = 0;
+            while (low < n) {
+                std::ptrdiff_t run = countRunAndMakeAscending(low, n);
+                if (run < minRun) {
+                    std::ptrdiff_t forced = std::min(minRun, n - low);
+                    binaryInsertionSort(low, low + forced, low + run);
+                    run = forced;
+                }
+                runs.push_back(Run{ low, run });
+                mergeCollapse();
+                low += run;
+            }
+            mergeForceCollapse();
+        }
+
+    private:
+        static const std::ptrdiff_t MIN_MERGE = 64;
+        static const std::ptrdiff_t MIN_GALLOP = 7;
+
+        struct Run {
+            std::ptrdiff_t base;
+            std::ptrdiff_t length;
+        };
+
+        /**
+         * @return Run length between MIN_MERGE/2 and MIN_MERGE such that
+         *         n / minRun is, or is just below, a power of two
+         */
+        static std::ptrdiff_t minRunLength(std::ptrdiff_t length) {
+            std::ptrdiff_t odd = 0;
+            while (length >= MIN_MERGE) {
+                odd |= length & 1;
+                length >>= 1;
+            }
+            return length + odd;
+        }
+
+        /**
+         * @return Length of the run starting at low, reversed in place if it
+         *         was strictly descending (strict, so reversal stays stable)
+         */
+        std::ptrdiff_t countRunAndMakeAscending(std::ptrdiff_t low, std::ptrdiff_t high) {
+            std::ptrdiff_t runHigh = low + 1;
+            if (runHigh == high) return 1;
+
+            if (less(a[runHigh++], a[low])) {
+                while (runHigh < high && less(a[runHigh], a[runHigh - 1])) {
+                    runHigh++;
+                }
+                std::reverse(a + low, a + runHigh);
+            }
+            else {
+                while (runHigh < high && !less(a[runHigh], a[runHigh - 1])) {
+                    runHigh++;
+                }
+            }
+            return runHigh - low;
+        }
+
+        /**
+         * Sorts a[low, high) given that a[low, start) is already sorted
+         */
+        void binaryInsertionSort(std::ptrdiff_t low, std::ptrdiff_t high, std::ptrdiff_t start) {
+            if (start == low) start++;
+            for (; start < high; start++) {
+                // Insert after any equal elements to stay stable
+                T* position = std::upper_bound(a + low, a + start, a[start], less);
+                if (position != a + start) {
+                    T pivot = std::move(a[start]);
+                    std::move_backward(position, a + start, a + start + 1);
+                    *position = std::move(pivot);
+                }
+            }
+        }
+
+        /**
+         * Merges adjacent runs until the stack invariants hold again:
+         * len[i - 2] > len[i - 1] + len[i] and len[i - 1] > len[i], checked
+         * over the top four runs so the invariant cannot break deeper down
+         */
+        void mergeCollapse() {
+            while (runs.size() > 1) {
+                std::ptrdiff_t i = static_cast<std::ptrdiff_t>(runs.size()) - 2;
+                if ((i > 0 && runs[i - 1].length <= runs[i].length + runs[i + 1].length) ||
+                    (i > 1 && runs[i - 2].length <= runs[i - 1].length + runs[i].length)) {
+                    if (runs[i - 1].length < runs[i + 1].length) {
+                        i--;
+                    }
+                }
+                else if (runs[i].length > runs[i + 1].length) {
+                    break;
+                }
+                mergeAt(i);
+            }
+        }
+
+        void mergeForceCollapse() {
+            while (runs.size() > 1) {
+                std::ptrdiff_t i = static_cast<std::ptrdiff_t>(runs.size()) - 2;
+                if (i > 0 && runs[i - 1].length < runs[i + 1].length) {
+                    i--;
+                }
+                mergeAt(i);
+            }
+        }
+
+        /**
+         * Merges runs i and i + 1, first trimming the parts of each that are
+         * already in place
+         */
+        void mergeAt(std::ptrdiff_t i) {
+            std::ptrdiff_t base1 = runs[i].base, length1 = runs[i].length;
+            std::ptrdiff_t base2 = runs[i + 1].base, length2 = runs[i + 1].length;
+
+            runs[i].length = length1 + length2;
+            runs.erase(runs.begin() + i + 1);
+
+            // Elements of run 1 not greater than run 2's first stay put
+            std::ptrdiff_t skip = gallopRight(a[base2], a + base1, length1, 0);
+            base1 += skip;
+            length1 -= skip;
+            if (length1 == 0) return;
+
+            // Elements of run 2 not less than run 1's last stay put
+            length2 = gallopLeft(a[base1 + length1 - 1], a + base2, length2, length2 - 1);
+            if (length2 == 0) return;
+
+            if (length1 <= length2) {
+                mergeLow(base1, length1, base2, length2);
+            }
+            else {
+                mergeHigh(base1, length1, base2, length2);
+            }
+        }
+
+        /**
+         * @return Position in run[0, length) of the first element not less
+         *         than key, searching outward from hint
+         */
+        std::ptrdiff_t gallopLeft(const T& key, const T* run, std::ptrdiff_t length, std::ptrdiff_t hint) {
+            std::ptrdiff_t lastOffset = 0, offset = 1;
+            if (less(run[hint], key)) {
+                std::ptrdiff_t maxOffset = length - hint;
+                while (offset < maxOffset && less(run[hint + offset], key)) {
+                    lastOffset = offset;
+                    offset = offset * 2 + 1;
+                }
+                offset = std::min(offset, maxOffset);
+                lastOffset += hint;
+                offset += hint;
+            }
+            else {
+                std::ptrdiff_t maxOffset = hint + 1;
+                while (offset < maxOffset && !less(run[hint - offset], key)) {
+                    lastOffset = offset;
+                    offset = offset * 2 + 1;
+                }
+                offset = std::min(offset, maxOffset);
+                std::ptrdiff_t previous = lastOffset;
+                lastOffset = hint - offset;
+                offset = hint - previous;
+            }
+
+            // run[lastOffset] < key <= run[offset]; binary search between
+            lastOffset++;
+            while (lastOffset < offset) {
+                std::ptrdiff_t middle = lastOffset + (offset - lastOffset) / 2;
+                if (less(run[middle], key)) lastOffset = middle + 1;
+                else offset = middle;
+            }
+            return offset;
+        }
+
+        /**
+         * @return Position in run[0, length) of the first element greater
+         *         than key, searching outward from hint
+         */
+        std::ptrdiff_t gallopRight(const T& key, const T* run, std::ptrdiff_t length, std::ptrdiff_t hint) {
+            std::ptrdiff_t lastOffset = 0, offset = 1;
+            if (less(key, run[hint])) {
+                std::ptrdiff_t maxOffset = hint + 1;
+                while (offset < maxOffset && less(key, run[hint - offset])) {
+                    lastOffset = offset;
+                    offset = offset * 2 + 1;
+                }
+                offset = std::min(offset, maxOffset);
+                std::ptrdiff_t previous = lastOffset;
+                lastOffset = hint - offset;
+                offset = hint - previous;
+            }
+            else {
+                std::ptrdiff_t maxOffset = length - hint;
+                while (offset < maxOffset && !less(key, run[hint + offset])) {
+                    lastOffset = offset;
+                    offset = offset * 2 + 1;
+                }
+                offset = std::min(offset, maxOffset);
+                lastOffset += hint;
+                offset += hint;
+            }
+
+            // run[lastOffset] <= key < run[offset]; binary search between
+            lastOffset++;
+            while (lastOffset < offset) {
+                std::ptrdiff_t middle = lastOffset + (offset - lastOffset) / 2;
+                if (less(key, run[middle])) offset = middle;
+                else lastOffset = middle + 1;
+            }
+            return offset;
+        }
+
+        T* buffer(std::ptrdiff_t length) {
+            if (static_cast<std::ptrdiff_t>(scratch.size()) < length) {
+                scratch.resize(length);
+            }
+            return scratch.data();
+        }
+
+        /**
+         * Merges run 1 (the shorter) into place front to back, with run 1
+         * moved out to the buffer
+         */
+        void mergeLow(std::ptrdiff_t base1, std::ptrdiff_t length1, std::ptrdiff_t base2, std::ptrdiff_t length2) {
+            T* tmp = buffer(length1);
+            std::move(a + base1, a + base1 + length1, tmp);
+
+            std::ptrdiff_t cursor1 = 0, cursor2 = base2, dest = base1;
+            a[dest++] = std::move(a[cursor2++]);
+            if (--length2 == 0) {
+                std::move(tmp + cursor1, tmp + cursor1 + length1, a + dest);
+                return;
+            }
+            if (length1 == 1) {
+                std::move(a + cursor2, a + cursor2 + length2, a + dest);
+                a[dest + length2] = std::move(tmp[cursor1]);
+                return;
+            }
+
+            std::ptrdiff_t gallop = minGallop;
+            while (true) {
+                std::ptrdiff_t count1 = 0, count2 = 0;   // consecutive wins per run
+
+                // One element at a time until one run starts winning steadily
+                do {
+                    if (less(a[cursor2], tmp[cursor1])) {
+                        a[dest++] = std::move(a[cursor2++]);
+                        count2++;
+                        count1 = 0;
+                        if (--length2 == 0) goto done;
+                    }
+                    else {
+                        a[dest++] = std::move(tmp[cursor1++]);
+                        count1++;
+                        count2 = 0;
+                        if (--length1 == 1) goto done;
+                    }
+                } while ((count1 | count2) < gallop);
+
+                // Gallop: find and move whole stretches at once
+                do {
+                    count1 = gallopRight(a[cursor2], tmp + cursor1, length1, 0);
+                    if (count1 != 0) {
+                        std::move(tmp + cursor1, tmp + cursor1 + count1, a + dest);
+                        dest += count1;
+                        cursor1 += count1;
+                        length1 -= count1;
+                        if (length1 <= 1) goto done;
+                    }
+                    a[dest++] = std::move(a[cursor2++]);
+                    if (--length2 == 0) goto done;
+
+                    count2 = gallopLeft(tmp[cursor1], a + cursor2, length2, 0);
+                    if (count2 != 0) {
+                        std::move(a + cursor2, a + cursor2 + count2, a + dest);
+                        dest += count2;
+                        cursor2 += count2;
+                        length2 -= count2;
+                        if (length2 == 0) goto done;
+                    }
+                    a[dest++] = std::move(tmp[cursor1++]);
+                    if (--length1 == 1) goto done;
+                    gallop--;
+                } while (count1 >= MIN_GALLOP || count2 >= MIN_GALLOP);
+
+                // Penalize leaving gallop mode
+                if (gallop < 0) gallop = 0;
+                gallop += 2;
+            }
+
+        done:
+            minGallop = (gallop < 1) ? 1 : gallop;
+            if (length1 == 1) {
+                std::move(a + cursor2, a + cursor2 + length2, a + dest);
+                a[dest + length2] = std::move(tmp[cursor1]);
+            }
+            else {
+                std::move(tmp + cursor1, tmp + cursor1 + length1, a + dest);
+            }
+        }
+
+        /**
+         * Merges run 2 (the shorter) into place back to front, with run 2
+         * moved out to the buffer
+         */
+        void mergeHigh(std::ptrdiff_t base1, std::ptrdiff_t length1, std::ptrdiff_t base2, std::ptrdiff_t length2) {
+            T* tmp = buffer(length2);
+            std::move(a + base2, a + base2 + length2, tmp);
+
+            std::ptrdiff_t cursor1 = base1 + length1 - 1, cursor2 = length2 - 1, dest = base2 + length2 - 1;
+            a[dest--] = std::move(a[cursor1--]);
+            if (--length1 == 0) {
+                std::move(tmp, tmp + length2, a + dest - (length2 - 1));
+                return;
+            }
+            if (length2 == 1) {
+                dest -= length1;
+                cursor1 -= length1;
+                std::move_backward(a + cursor1 + 1, a + cursor1 + 1 + length1, a + dest + 1 + length1);
+                a[dest] = std::move(tmp[cursor2]);
+                return;
+            }
+
+            std::ptrdiff_t gallop = minGallop;
+            while (true) {
+                std::ptrdiff_t count1 = 0, count2 = 0;   // consecutive wins per run
+
+                do {
+                    if (less(tmp[cursor2], a[cursor1])) {
+                        a[dest--] = std::move(a[cursor1--]);
+                        count1++;
+                        count2 = 0;
+                        if (--length1 == 0) goto done;
+                    }
+                    else {
+                        a[dest--] = std::move(tmp[cursor2--]);
+                        count2++;
+                        count1 = 0;
+                        if (--length2 == 1) goto done;
+                    }
+                } while ((count1 | count2) < gallop);
+
+                do {
+                    count1 = length1 - gallopRight(tmp[cursor2], a + base1, length1, length1 - 1);
+                    if (count1 != 0) {
+                        dest -= count1;
+                        cursor1 -= count1;
+                        length1 -= count1;
+                        std::move_backward(a + cursor1 + 1, a + cursor1 + 1 + count1, a + dest + 1 + count1);
+                        if (length1 == 0) goto done;
+                    }
+                    a[dest--] = std::move(tmp[cursor2--]);
+                    if (--length2 == 1) goto done;
+
+                    count2 = length2 - gallopLeft(a[cursor1], tmp, length2, length2 - 1);
+                    if (count2 != 0) {
+                        dest -= count2;
+                        cursor2 -= count2;
+                        length2 -= count2;
+                        std::move(tmp + cursor2 + 1, tmp + cursor2 + 1 + count2, a + dest + 1);
+                        if (length2 <= 1) goto done;
+                    }
+                    a[dest--] = std::move(a[cursor1--]);
+                    if (--length1 == 0) goto done;
+                    gallop--;
+                } while (count1 >= MIN_GALLOP || count2 >= MIN_GALLOP);
+
+                if (gallop < 0) gallop = 0;
+                gallop += 2;
+            }
+
+        done:
+            minGallop = (gallop < 1) ? 1 : gallop;
+            if (length2 == 1) {
+                dest -= length1;
+                cursor1 -= length1;
+                std::move_backward(a + cursor1 + 1, a + cursor1 + 1 + length1, a + dest + 1 + length1);
+                a[dest] = std::move(tmp[cursor2]);
+            }
+            else {
+                std::move(tmp, tmp + length2, a + dest - (length2 - 1));
+            }
+        }
+
+        T* a;
+        std::ptrdiff_t n;
+        Less less;
+        std::ptrdiff_t minGallop;
+        std::vector<Run> runs;
+        std::vector<T> scratch;
+    };
+
+    static std::atomic<size_t>& cutoffSetting() {
+        static std::atomic<size_t> cutoff(4096);
+        return cutoff;
+    }
+
+    template<typename T, typename Less>
+    static void parallelQuickSortRange(std::vector<T>& items, size_t begin, size_t end, Less less,
+        ThreadPool& pool, size_t cutoff) {
+        if (end - begin < cutoff) {
+            quickSortBy(items, begin, end, less);
+            return;
+        }
+
+        size_t pivotIndex = partition(items, begin, end, less);
+
+        ThreadPool::TaskGroup group;
+        if (pivotIndex > begin) {
+            pool.run(group, [&items, begin, pivotIndex, less, &pool, cutoff] {
+                parallelQuickSortRange(items, begin, pivotIndex, less, pool, cutoff);
+            });
+        }
+        if (pivotIndex < end) {
+            parallelQuickSortRange(items, pivotIndex + 1, end, less, pool, cutoff);
+        }
+        pool.wait(group);
+    }
+
+    /**
+     * Sorts items[begin, end); the result lands in scratch if intoScratch,
+     * otherwise back in items
+     */
+    template<typename T, typename Less>
+    static void parallelMergeSortRange(std::vector<T>& items, std::vector<T>& scratch, size_t begin, size_t end,
+        bool intoScratch, Less less, ThreadPool& pool, size_t cutoff) {
+        if (end - begin <= cutoff) {
+            bufferedMergeRange(items, scratch, begin, end, intoScratch, less);
+            return;
+        }
+
+        // Sort the halves into the other buffer, then merge into the target
+        size_t mid = begin + (end - begin) / 2;
+        ThreadPool::TaskGroup group;
+        pool.run(group, [&items, &scratch, begin, mid, intoScratch, less, &pool, cutoff] {
+            parallelMergeSortRange(items, scratch, begin, mid, !intoScratch, less, pool, cutoff);
+        });
+        parallelMergeSortRange(items, scratch, mid, end, !intoScratch, less, pool, cutoff);
+        pool.wait(group);
+
+        std::vector<T>& source = intoScratch ? items : scratch;
+        std::vector<T>& target = intoScratch ? scratch : items;
+        parallelMerge(source, begin, mid, mid, end, target, begin, less, pool, cutoff);
+    }
+
+    /**
+     * Bottom-up buffered merge sort of items[begin, end), ping-ponging
+     * between items and scratch like bufferedMergeSortBy, with the result
+     * landing in scratch if intoScratch, otherwise in items. The insertion
+     * run length is halved when that makes the pass count end in the right
+     * buffer, so the range is only moved across when it is too short to
+     * merge at all. Elements are moved, never copied.
+     */
+    template<typename T, typename Less>
+    static void bufferedMergeRange(std::vector<T>& items, std::vector<T>& scratch, size_t begin, size_t end,
+        bool intoScratch, Less less) {
+        size_t n = end - begin;
+        size_t insertionRun = 32;
+        size_t passes = 0;
+        for (size_t width = insertionRun; width < n; width *= 2) {
+            ++passes;
+        }
+        if (passes > 0 && (passes % 2 == 1) != intoScratch) {
+            insertionRun /= 2;
+            ++passes;
+        }
+
+        for (size_t run = begin; run < end; run += insertionRun) {
+            insertionSort(items, run, std::min(run + insertionRun, end), less);
+        }
+        std::vector<T>* from = &items;
+        std::vector<T>* to = &scratch;
+        for (size_t width = insertionRun; width < n; width *= 2) {
+            for (size_t left = begin; left < end; left += 2 * width) {
+                size_t mid = std::min(left + width, end);
+                size_t right = std::min(left + 2 * width, end);
+                mergeMove(*from, *to, left, mid, right, less);
+            }
+            std::swap(from, to);
+        }
+        if ((from == &scratch) != intoScratch) {
+            std::move(from->begin() + begin, from->begin() + end, to->begin() + begin);
+        }
+    }
+
+    /**
+     * Stable merge of source[left, leftEnd) and source[right, rightEnd),
+     * moved into target starting at out; the source ranges are left
+     * moved-from. Concurrent calls only touch disjoint ranges.
+     */
+    template<typename T, typename Less>
+    static void parallelMerge(std::vector<T>& source, size_t left, size_t leftEnd, size_t right, size_t rightEnd,
+        std::vector<T>& target, size_t out, Less less, ThreadPool& pool, size_t cutoff) {
+        size_t leftSize = leftEnd - left;
+        size_t rightSize = rightEnd - right;
+
+        if (leftSize + rightSize <= cutoff) {
+            while (left < leftEnd && right < rightEnd) {
+                if (!less(source[right], source[left])) {
+                    target[out++] = std::move(source[left++]);
+                }
+                else {
+                    target[out++] = std::move(source[right++]);
+                }
+            }
+            out = std::move(source.begin() + left, source.begin() + leftEnd, target.begin() + out) - target.begin();
+            std::move(source.begin() + right, source.begin() + rightEnd, target.begin() + out);
+            return;
+        }
+
+        // Split the larger run at its middle element and find where that
+        // element falls in the other run. Equal elements from the left run
+        // stay ahead of those from the right run, which keeps it stable.
+        size_t leftSplit, rightSplit;
+        if (leftSize >= rightSize) {
+            leftSplit = left + leftSize / 2;
+            rightSplit = std::lower_bound(source.begin() + right, source.begin() + rightEnd,
+                source[leftSplit], less) - source.begin();
+        }
+        else {
+            rightSplit = right + rightSize / 2;
+            leftSplit = std::upper_bound(source.begin() + left, source.begin() + leftEnd,
+                source[rightSplit], less) - source.begin();
+        }
+        size_t outSplit = out + (leftSplit - left) + (rightSplit - right);
+
+        ThreadPool::TaskGroup group;
+        pool.run(group, [&source, left, leftSplit, right, rightSplit, &target, out, less, &pool, cutoff] {
+            parallelMerge(source, left, leftSplit, right, rightSplit, target, out, less, pool, cutoff);
+        });
+        parallelMerge(source, leftSplit, leftEnd, rightSplit, rightEnd, target, outSplit, less, pool, cutoff);
+        pool.wait(group);
+    }
+
+    static void prepareOrder(const BidTable& table, std::vector<uint32_t>& order) {
+        if (order.size() != table.size()) {
+            order = table.identity();
+        }
+    }
+
+    /**
+     * Runs algorithm(order, less) with the comparator spec calls for: the
+     * specialized TableTitleLess for plain title order, otherwise spec
+     */
+    template<typename Algorithm>
+    static void sortTable(const BidTable& table, std::vector<uint32_t>& order, const SortSpec& spec,
+        Algorithm algorithm) {
+        prepareOrder(table, order);
+        if (order.empty()) return;
+        if (spec.isTitleOnly()) {
+            algorithm(order, TableTitleLess(table));
+        }
+        else {
+            algorithm(order, TableLess<SortSpec>(table, spec));
+        }
+    }
+
+    template<typename Algorithm>
+    static void sortKeyed(std::vector<Bid>& bids, const SortSpec& spec, Algorithm algorithm) {
+        if (bids.empty()) return;
+        std::vector<SortKey> keys = makeKeys(bids, spec[0]);
+        if (spec.isTitleOnly()) {
+            algorithm(keys, KeyLess<TitleLess>(bids));
+        }
+        else {
+            algorithm(keys, KeyLess<SortSpec>(bids, spec));
+        }
+        applyKeys(bids, keys);
+    }
+
+    static std::vector<SortKey> makeKeys(const std::vector<Bid>& bids, const SortKeySpec& first) {
+        std::vector<SortKey> keys(bids.size());
+        for (size_t i = 0; i < bids.size(); ++i) {
+            keys[i].prefix = keyPrefix(bids[i], first);
+            keys[i].row = static_cast<uint32_t>(i);
+        }
+        return keys;
+    }
+
+    /**
+     * Stable LSD radix sort of keys by prefix, 8 bits per pass
+     */
+    static void radixSortKeys(std::vector<SortKey>& keys) {
+        std::vector<SortKey> buffer(keys.size());
+        for (int shift = 0; shift < 64; shift += 8) {
+            size_t counts[256] = {};
+            for (const auto& key : keys) {
+                counts[(key.prefix >> shift) & 0xFF]++;
+            }
+            if (counts[(keys[0].prefix >> shift) & 0xFF] == keys.size()) {
+                continue;   // every key has the same byte here
+            }
+            size_t offset = 0;
+            for (auto& count : counts) {
+                size_t n = count;
+                count = offset;
+                offset += n;
+            }
+            for (const auto& key : keys) {
+                buffer[counts[(key.prefix >> shift) & 0xFF]++] = key;
+            }
+            keys.swap(buffer);
+        }
+    }
+
+    /**
+     * A bid's first-key text and its row, for multikeyQuickSort
+     */
+    struct TextKey {
+        const char* data;
+        uint32_t size;
+        uint32_t row;
+    };
+
+    /**
+     * Byte depth of key as a radix digit: 0-255, or END once the text is
+     * exhausted; descending order mirrors the digits so END sorts last
+     */
+    static int digitAt(const TextKey& key, size_t depth, bool descending) {
+        if (depth >= key.size) {
+            return descending ? 256 : -1;
+        }
+        int digit = static_cast<unsigned char>(key.data[depth]);
+        return descending ? 255 - digit : digit;
+    }
+
+    /**
+     * Multikey quicksort of keys[begin, end), whose first depth bytes are
+     * known to be equal
+     */
+    static void multikeyRange(std::vector<TextKey>& keys, size_t begin, size_t end, size_t depth,
+        const std::vector<Bid>& bids, const SortSpec& tiebreak, bool descending) {
+        const size_t insertionThreshold = 16;
+        const int endDigit = descending ? 256 : -1;
+
+        while (end - begin > 1) {
+            if (end - begin <= insertionThreshold) {
+                insertionSort(keys, begin, end, [&](const TextKey& a, const TextKey& b) {
+                    std::string_view x(a.data + depth, a.size - depth);
+                    std::string_view y(b.data + depth, b.size - depth);
+                    int order = descending ? y.compare(x) : x.compare(y);
+                    return order != 0 ? order < 0 : tiebreak(bids[a.row], bids[b.row]);
+                });
+                return;
+            }
+
+            // Three-way partition on the median of three digits
+            int first = digitAt(keys[begin], depth, descending);
+            int middle = digitAt(keys[begin + (end - begin) / 2], depth, descending);
+            int last = digitAt(keys[end - 1], depth, descending);
+            int pivot = std::max(std::min(first, middle), std::min(std::max(first, middle), last));
+
+            size_t lower = begin, upper = end, i = begin;
+            while (i < upper) {
+                int digit = digitAt(keys[i], depth, descending);
+                if (digit < pivot) {
+                    std::swap(keys[lower++], keys[i++]);
+                }
+                else if (digit > pivot) {
+                    std::swap(keys[i], keys[--upper]);
+                }
+                else {
+                    ++i;
+                }
+            }
+
+            multikeyRange(keys, begin, lower, depth, bids, tiebreak, descending);
+            multikeyRange(keys, upper, end, depth, bids, tiebreak, descending);
+
+            if (pivot == endDigit) {
+                // Equal first keys: settle them on the remaining keys
+                if (tiebreak.size() > 0) {
+                    introSortBy(keys, lower, upper, [&](const TextKey& a, const TextKey& b) {
+                        return tiebreak(bids[a.row], bids[b.row]);
+                    });
+                }
+                return;
+            }
+            begin = lower;
+            end = upper;
+            ++depth;
+        }
+    }
+
+    template<typename Key>
+    static void applyKeys(std::vector<Bid>& bids, const std::vector<Key>& keys) {
+        std::vector<Bid> sorted;
+        sorted.reserve(bids.size());
+        for (const auto& key : keys) {
+            sorted.push_back(bids[key.row]);
+        }
+        bids.swap(sorted);
+    }
+};
+
+#endif /*!_BIDSORTER_HPP_*/
@@ -0,0 +1,199 @@
+//============================================================================
+// Name        : BidWriter.hpp
+// Description : Buffered bulk output of bids as display lines or CSV
+//============================================================================
+
+#ifndef _BIDWRITER_HPP_
+#define _BIDWRITER_HPP_
+
+#include <charconv>
+#include <cstddef>
+#include <ostream>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include "Bid.hpp"
+
+/**
+ * Layouts BidWriter can produce
+ */
+enum BidFormat {
+    eDISPLAY = 0,   // "id: title | $amount | fund", as the menu shows bids
+    eCSV = 1        // the export's columns, so a written file loads back like the original
+};
+
+/**
+ * Formats bids into one reusable buffer and hands the stream whole buffers
+ *
+ * Nothing is flushed per row: the stream sees a write only when the buffer
+ * fills, and is flushed only by flush() (or the destructor). Amounts are
+ * formatted with std::to_chars, which neither allocates nor consults the
+ * stream's locale and precision state.
+ *
+ * CSV output puts the title, id, winning bid and fund in columns 0, 1, 4
+ * and 8, the columns the loader selects, and leaves the others empty. Bid
+ * text is stored as it appeared in the source file, quotes included, so a
+ * field that is already quoted is written unchanged; any other field that
+ * needs quoting gets it.
+ */
+class BidWriter {
+public:
+    /**
+     * @param out Stream to write to; must outlive the writer
+     * @param format Row layout
+     * @param capacity Buffer size in bytes
+     */
+    explicit BidWriter(std::ostream& out, BidFormat format = eDISPLAY, size_t capacity = 1 << 16)
+        : out(out), format(format), buffer(capacity < 1024 ? 1024 : capacity), used(0), count(0) {
+    }
+
+    ~BidWriter() {
+        try {
+            flush();
+        }
+        catch (...) {
+        }
+    }
+
+    BidWriter(const BidWriter&) = delete;
+    BidWriter& operator=(const BidWriter&) = delete;
+
+    /**
+     * Writes the CSV header row; does nothing for display output
+     */
+    void writeHeader() {
+        if (format == eCSV) {
+            text("Auction Title,Auction ID,Department,Close Date,Winning Bid,"
+                 "CC Fee,Fee Percent,Auction Fee Subtotal,Fund\n");
+        }
+    }
+
+    /**
+     * Writes one bid as a row
+     */
+    void write(const Bid& bid) {
+        if (format == eCSV) {
+            field(bid.title);
+            text(",");
+            field(bid.bidId);
+            text(",,,");
+            amount(bid.amount);
+            text(",,,,");
+            field(bid.fund);
+            text("\n");
+        }
+        else {
+            text(bid.bidId);
+            text(": ");
+            text(bid.title);
+            text(" | $");
+            amount(bid.amount);
+            text(" | ");
+            text(bid.fund);
+            text("\n");
+        }
+        ++count;
+    }
+
+    /**
+     * Writes bids[first, first + rows), clipped to the end of bids
+     */
+    void write(const std::vector<Bid>& bids, size_t first = 0, size_t rows = static_cast<size_t>(-1)) {
+        size_t last = (first >= bids.size() || rows >= bids.size() - first) ? bids.size() : first + rows;
+        for (size_t i = first; i < last; ++i) {
+            write(bids[i]);
+        }
+    }
+
+    /**
+     * Appends text as is, e.g. a rank in front of a row
+     */
+    void text(std::string_view value) {
+        if (value.size() > buffer.size() - used) {
+            drain();
+            if (value.size() > buffer.size()) {
+                out.write(value.data(), static_cast<std::streamsize>(value.size()));
+                return;
+            }
+        }
+        value.copy(buffer.data() + used, value.size());
+        used += value.size();
+    }
+
+    /**
+     * Appends a number in decimal
+     */
+    void number(size_t value) {
+        char digits[24];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        text(std::string_view(digits, static_cast<size_t>(result.ptr - digits)));
+    }
+
+    /**
+     * Hands the buffered bytes to the stream and flushes it
+     *
+     * @return false if the stream has failed
+     */
+    bool flush() {
+        drain();
+        out.flush();
+        return static_cast<bool>(out);
+    }
+
+    /**
+     * @return Bids written so far
+     */
+    size_t rows() const { return count; }
+
+private:
+    std::ostream& out;
+    BidFormat format;
+    std::vector<char> buffer;
+    size_t used;
+    size_t count;
+
+    void drain() {
+        if (used > 0) {
+            out.write(buffer.data(), static_cast<std::streamsize>(used));
+            used = 0;
+        }
+    }
+
+    /**
+     * Appends an amount with two decimals, as fixed << setprecision(2) would
+     */
+    void amount(double value) {
+        // Fixed notation of the largest double needs 309 integer digits
+        char digits[320];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value, std::chars_format::fixed, 2);
+        if (result.ec != std::errc()) {
+            text("0.00");
+            return;
+        }
+        text(std::string_view(digits, static_cast<size_t>(result.ptr - digits)));
+    }
+
+    /**
+     * Appends a CSV field, quoting it unless it is already quoted or needs
+     * no quotes
+     */
+    void field(std::string_view value) {
+        bool quoted = value.size() >= 2 && value.front() == '"' && value.back() == '"';
+        if (quoted || value.find_first_of(",\"\r\n") == std::string_view::npos) {
+            text(value);
+            return;
+        }
+        text("\"");
+        size_t start = 0;
+        for (size_t quote = value.find('"'); quote != std::string_view::npos; quote = value.find('"', start)) {
+            text(value.substr(start, quote + 1 - start));
+            text("\"");
+            start = quote + 1;
+        }
+        text(value.substr(start));
+        text("\"");
+    }
+};
+
+#endif /*!_BIDWRITER_HPP_*/
@@ -1,15 +1,474 @@
 #include <fstream>
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
+#include <thread>
+#include <exception>
+#include <utility>
 #include "CSVparser.hpp"
 
+#ifdef _WIN32
+# ifndef NOMINMAX
+#  define NOMINMAX
+# endif
+# define WIN32_LEAN_AND_MEAN
+# include <windows.h>
+#else
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__)
+# include <immintrin.h>
+# define CSV_SCAN_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+# include <emmintrin.h>
+# define CSV_SCAN_SSE2 1
+#elif defined(__aarch64__) || defined(_M_ARM64)
+# include <arm_neon.h>
+# define CSV_SCAN_NEON 1
+#endif
+
+#if defined(__PCLMUL__)
+# include <wmmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+# include <intrin.h>
+#endif
+
+namespace
+{
+  /*
+  ** Tokenizer core shared by every parse mode. Input is classified 64 bytes
+  ** at a time into quote / separator / newline bitmaps; a prefix-XOR of the
+  ** quote bits gives the "inside quotes" mask (the same toggle the byte loop
+  ** used to keep), and whatever separators and newlines remain outside it are
+  ** handed to the caller in order. No byte is looked at twice.
+  */
+  struct BlockMasks
+  {
+      uint64_t quote;
+      uint64_t sep;
+      uint64_t newline;
+  };
+
+#if defined(CSV_SCAN_AVX2)
+  inline uint64_t matches(__m256i lo, __m256i hi, char c)
+  {
+      const __m256i needle = _mm256_set1_epi8(c);
+      uint64_t l = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, needle)));
+      uint64_t h = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, needle)));
+      return l | (h << 32);
+  }
+
+  inline BlockMasks scanBlock(const char *p, char sep)
+  {
+      const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+      const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + 32));
+      BlockMasks m;
+      m.quote = matches(lo, hi, '"');
+      m.sep = matches(lo, hi, sep);
+      m.newline = matches(lo, hi, '\n');
+      return m;
+  }
+#elif defined(CSV_SCAN_SSE2)
+  inline uint64_t matches(const __m128i *v, char c)
+  {
+      const __m128i needle = _mm_set1_epi8(c);
+      uint64_t m0 = static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v[0], needle)));
+      uint64_t m1 = static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v[1], needle)));
+      uint64_t m2 = static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v[2], needle)));
+      uint64_t m3 = static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v[3], needle)));
+      return m0 | (m1 << 16) | (m2 << 32) | (m3 << 48);
+  }
+
+  inline BlockMasks scanBlock(const char *p, char sep)
+  {
+      __m128i v[4];
+      for (int i = 0; i < 4; i++)
+          v[i] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 16 * i));
+      BlockMasks m;
+      m.quote = matches(v, '"');
+      m.sep = matches(v, sep);
+      m.newline = matches(v, '\n');
+      return m;
+  }
+#elif defined(CSV_SCAN_NEON)
+  inline uint64_t matches(const uint8x16_t *v, char c)
+  {
+      static const uint8_t weights[16] = { 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80,
+                                           0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80 };
+      const uint8x16_t bits = vld1q_u8(weights);
+      const uint8x16_t needle = vdupq_n_u8(static_cast<uint8_t>(c));
+      uint8x16_t t0 = vandq_u8(vceqq_u8(v[0], needle), bits);
+      uint8x16_t t1 = vandq_u8(vceqq_u8(v[1], needle), bits);
+      uint8x16_t t2 = vandq_u8(vceqq_u8(v[2], needle), bits);
+      uint8x16_t t3 = vandq_u8(vceqq_u8(v[3], needle), bits);
+      uint8x16_t sum = vpaddq_u8(vpaddq_u8(t0, t1), vpaddq_u8(t2, t3));
+      sum = vpaddq_u8(sum, sum);
+      return vgetq_lane_u64(vreinterpretq_u64_u8(sum), 0);
+  }
+
+  inline BlockMasks scanBlock(const char *p, char sep)
+  {
+      uint8x16_t v[4];
+      for (int i = 0; i < 4; i++)
+          v[i] = vld1q_u8(reinterpret_cast<const uint8_t *>(p + 16 * i));
+      BlockMasks m;
+      m.quote = matches(v, '"');
+      m.sep = matches(v, sep);
+      m.newline = matches(v, '\n');
+      return m;
+  }
+#else
+  inline BlockMasks scanBlock(const char *p, char sep)
+  {
+      BlockMasks m = { 0, 0, 0 };
+      for (int i = 0; i < 64; i++)
+      {
+          const uint64_t bit = uint64_t(1) << i;
+          if (p[i] == '"')
+              m.quote |= bit;
+          else if (p[i] == sep)
+              m.sep |= bit;
+          else if (p[i] == '\n')
+              m.newline |= bit;
+      }
+      return m;
+  }
+#endif
+
+  // bit i of the result is the XOR of bits 0..i of x
+  inline uint64_t prefixXor(uint64_t x)
+  {
+#if defined(__PCLMUL__)
+      const __m128i product = _mm_clmulepi64_si128(
+          _mm_set_epi64x(0, static_cast<long long>(x)), _mm_set1_epi8(static_cast<char>(0xFF)), 0);
+      return static_cast<uint64_t>(_mm_cvtsi128_si64(product));
+#else
+      x ^= x << 1;
+      x ^= x << 2;
+      x ^= x << 4;
+      x ^= x << 8;
+      x ^= x << 16;
+      x ^= x << 32;
+      return x;
+#endif
+  }
+
+  inline unsigned int trailingZeros(uint64_t x)
+  {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+      unsigned long index;
+      _BitScanForward64(&index, x);
+      return static_cast<unsigned int>(index);
+#elif defined(_MSC_VER)
+      unsigned long index;
+      if (_BitScanForward(&index, static_cast<unsigned long>(x)))
+          return static_cast<unsigned int>(index);
+      _BitScanForward(&index, static_cast<unsigned long>(x >> 32));
+      return static_cast<unsigned int>(index) + 32;
+#else
+      return static_cast<unsigned int>(__builtin_ctzll(x));
+#endif
+  }
+
+  /*
+  ** Calls onSep(pos) / onNewline(pos) for every separator and newline of
+  ** [begin, end) that is not inside quotes, in input order. begin must not
+  ** be inside a quoted field.
+  */
+  template<typename OnSep, typename OnNewline>
+  void scanDelimiters(const char *begin, const char *end, char sep,
+                      OnSep onSep, OnNewline onNewline)
+  {
+      uint64_t inQuotes = 0;    // all ones while carrying an open quote
+      char tail[64];
+
+      for (const char *block = begin; block < end; block += 64)
+      {
+          const size_t avail = static_cast<size_t>(end - block);
+          BlockMasks m;
+          if (avail >= 64)
+              m = scanBlock(block, sep);
+          else
+          {
+              // never read past the input: the last partial block is padded
+              std::memcpy(tail, block, avail);
+              std::memset(tail + avail, 0, 64 - avail);
+              m = scanBlock(tail, sep);
+              const uint64_t valid = (uint64_t(1) << avail) - 1;
+              m.quote &= valid;
+              m.sep &= valid;
+              m.newline &= valid;
+          }
+
+          const uint64_t quoted = prefixXor(m.quote) ^ inQuotes;
+          inQuotes = static_cast<uint64_t>(static_cast<int64_t>(quoted) >> 63);
+
+          uint64_t structural = (m.sep | m.newline) & ~quoted;
+          while (structural)
+          {
+              const uint64_t bit = structural & (0 - structural);
+              const char *pos = block + trailingZeros(structural);
+              structural ^= bit;
+              if (m.newline & bit)
+                  onNewline(pos);
+              else
+                  onSep(pos);
+          }
+      }
+  }
+}
+
 namespace csv {
 
-  Parser::Parser(const std::string &data, const DataType &type, char sep)
-    : _type(type), _sep(sep)
+  namespace
+  {
+    /*
+    ** Turn the requested columns (positions and/or header names) into a
+    ** per-column slot table. Names match exactly first; failing that, they
+    ** match ignoring surrounding blanks, since exports pad some headers.
+    */
+    void resolveSlots(const std::vector<std::string> &header, const Options &options,
+                      std::vector<int> &slots, unsigned int &stride)
+    {
+        slots.clear();
+        stride = header.size();
+        if (options.columns.empty() && options.columnNames.empty())
+            return;
+
+        std::vector<bool> keep(header.size(), false);
+        for (auto it = options.columns.begin(); it != options.columns.end(); it++)
+        {
+            if (*it >= header.size())
+              throw Error("can't select this column (doesn't exist)");
+            keep[*it] = true;
+        }
+
+        auto trim = [](const std::string &s) {
+            const size_t b = s.find_first_not_of(" \t\r");
+            if (b == std::string::npos)
+                return std::string();
+            return s.substr(b, s.find_last_not_of(" \t\r") - b + 1);
+        };
+        for (auto it = options.columnNames.begin(); it != options.columnNames.end(); it++)
+        {
+            size_t pos = std::find(header.begin(), header.end(), *it) - header.begin();
+            if (pos == header.size())
+            {
+                const std::string wanted = trim(*it);
+                for (pos = 0; pos < header.size(); pos++)
+                    if (trim(header[pos]) == wanted)
+                        break;
+            }
+            if (pos == header.size())
+              throw Error(std::string("can't select this column (doesn't exist): ").append(*it));
+            keep[pos] = true;
+        }
+
+        slots.assign(header.size(), -1);
+        stride = 0;
+        for (unsigned int i = 0; i < header.size(); i++)
+            if (keep[i])
+                slots[i] = stride++;
+    }
+
+    /*
+    ** Index every record in [begin, end), which must start on a record
+    ** boundary, appending the kept fields (see slots) to fields. Returns
+    ** the number of records indexed.
+    **
+    ** When complete is given the input may stop in the middle of a record:
+    ** only records closed by a newline are kept, and *complete is set just
+    ** past the last of them so the caller can carry the rest over.
+    */
+    unsigned int indexRecords(const char *begin, const char *end, char sep, size_t columns,
+                              const int *slots, std::vector<std::string_view> &fields,
+                              const char **complete = nullptr)
+    {
+        unsigned int rows = 0;
+        const char *tokenStart = begin;
+        size_t column = 0;    // fields seen so far in the current record
+        const char *closed = begin;
+        size_t kept = fields.size();
+
+        // only columns in the projection are indexed
+        auto field = [&](const char *tokenEnd) {
+            if (slots == nullptr || (column < columns && slots[column] >= 0))
+                fields.emplace_back(tokenStart, tokenEnd - tokenStart);
+            column++;
+        };
+
+        // closes the record whose last field ends at tokenEnd
+        auto endRecord = [&](const char *tokenEnd) {
+            // blank line
+            if (column == 0 &&
+                (tokenEnd == tokenStart || (tokenEnd == tokenStart + 1 && *tokenStart == '\r')))
+                return;
+
+            if (tokenEnd > tokenStart && tokenEnd[-1] == '\r')
+                tokenEnd--;
+            field(tokenEnd);
+
+            // if value(s) missing
+            if (column != columns)
+              throw Error("corrupted data !");
+            rows++;
+            column = 0;
+        };
+
+        scanDelimiters(begin, end, sep,
+            [&](const char *s) {
+                field(s);
+                tokenStart = s + 1;
+            },
+            [&](const char *newline) {
+                endRecord(newline);
+                tokenStart = newline + 1;
+                closed = tokenStart;
+                kept = fields.size();
+            });
+
+        if (complete != nullptr)
+        {
+            // drop the trailing partial record, it is indexed again later
+            fields.resize(kept);
+            *complete = closed;
+        }
+        //end
+        else if (tokenStart < end || column != 0)
+            endRecord(end);
+        return rows;
+    }
+
+    // not worth a thread for less input than this
+    const size_t minParallelChunk = 1 << 20;
+
+    /*
+    ** Number of threads to index length bytes with: threads, or one per
+    ** core for 0, but never less than minParallelChunk bytes each
+    */
+    unsigned int indexThreads(unsigned int threads, size_t length)
+    {
+        if (threads == 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        return static_cast<unsigned int>(
+            std::min<size_t>(threads, std::max<size_t>(1, length / minParallelChunk)));
+    }
+
+    /*
+    ** Split [begin, end), which starts on a record boundary, into one byte
+    ** range per thread. A split point may only sit right after a newline
+    ** that is outside quotes, so the quote state at every nominal cut is
+    ** worked out first from the per-range quote counts (an odd count flips
+    ** it). Returns threads + 1 cuts; ranges may be empty.
+    */
+    std::vector<const char *> recordCuts(const char *begin, const char *end, unsigned int threads)
+    {
+        const size_t length = end - begin;
+        std::vector<const char *> cuts(threads + 1);
+        for (unsigned int t = 0; t <= threads; t++)
+            cuts[t] = begin + length * t / threads;
+
+        std::vector<size_t> quotes(threads, 0);
+        {
+            std::vector<std::thread> workers;
+            for (unsigned int t = 0; t < threads; t++)
+                workers.emplace_back([&, t]() {
+                    quotes[t] = std::count(cuts[t], cuts[t + 1], '"');
+                });
+            for (auto &w : workers)
+                w.join();
+        }
+
+        // move each inner cut forward to the first record boundary
+        bool quoted = false;
+        for (unsigned int t = 1; t < threads; t++)
+        {
+            quoted ^= (quotes[t - 1] & 1) != 0;
+            const char *p = cuts[t];
+            bool inQuotes = quoted;
+            for (; p < end; p++)
+            {
+                if (*p == '"')
+                    inQuotes = !inQuotes;
+                else if (*p == '\n' && !inQuotes)
+                    break;
+            }
+            // a record longer than a whole range leaves that range empty
+            cuts[t] = std::max(cuts[t - 1], (p < end) ? p + 1 : end);
+        }
+        return cuts;
+    }
+
+    /*
+    ** Index the ranges between consecutive cuts concurrently, calling
+    ** index(begin, end, fields, last) for each, and append their fields to
+    ** fields in order. Returns the total number of records; rethrows the
+    ** error of the first failing range, as a sequential scan would.
+    */
+    template<typename Index>
+    unsigned int indexRanges(const std::vector<const char *> &cuts, std::vector<std::string_view> &fields,
+                             Index index)
+    {
+        const size_t ranges = cuts.size() - 1;
+        std::vector<std::vector<std::string_view> > parts(ranges);
+        std::vector<unsigned int> rows(ranges, 0);
+        std::vector<std::exception_ptr> errors(ranges);
+        {
+            std::vector<std::thread> workers;
+            for (size_t t = 0; t < ranges; t++)
+                workers.emplace_back([&, t]() {
+                    try
+                    {
+                        rows[t] = index(cuts[t], cuts[t + 1], parts[t], t + 1 == ranges);
+                    }
+                    catch (...)
+                    {
+                        errors[t] = std::current_exception();
+                    }
+                });
+            for (auto &w : workers)
+                w.join();
+        }
+
+        for (size_t t = 0; t < ranges; t++)
+            if (errors[t])
+                std::rethrow_exception(errors[t]);
+
+        size_t total = fields.size();
+        for (size_t t = 0; t < ranges; t++)
+            total += parts[t].size();
+        fields.reserve(total);
+        unsigned int count = 0;
+        for (size_t t = 0; t < ranges; t++)
+        {
+            fields.insert(fields.end(), parts[t].begin(), parts[t].end());
+            count += rows[t];
+            std::vector<std::string_view>().swap(parts[t]);
+        }
+        return count;
+    }
+  }
+
+  Parser::Parser(const std::string &data, const DataType &type, char sep, const Options &options)
+    : _type(type), _sep(sep), _options(options), _stride(0), _rows(0)
   {
       std::string line;
-      if (type == eFILE)
+      if (type == eMMAP)
+      {
+        _file = data;
+        _map.reset(new MappedFile(_file));
+        indexContent();
+      }
+      else if (type == eFILE)
       {
         _file = data;
         std::ifstream ifile(_file.c_str());
@@ -56,11 +515,25 @@ namespace csv {
 
   void Parser::parseHeader(void)
   {
-      std::stringstream ss(_originalFile[0]);
+      parseHeader(_originalFile[0]);
+  }
+
+  void Parser::parseHeader(const std::string &line)
+  {
+      std::stringstream ss(line);
       std::string item;
+      std::vector<std::string> names;
 
       while (std::getline(ss, item, _sep))
-          _header.push_back(item);
+          names.push_back(item);
+
+      _header = std::make_shared<const Header>(names);
+      resolveProjection();
+  }
+
+  void Parser::resolveProjection(void)
+  {
+      resolveSlots(_header->names(), _options, _slots, _stride);
   }
 
   void Parser::parseContent(void)
@@ -72,40 +545,117 @@ namespace csv {
 
      for (; it != _originalFile.end(); it++)
      {
-         bool quoted = false;
-         int tokenStart = 0;
-         unsigned int i = 0;
+         const char *line = it->data();
+         const char *tokenStart = line;
 
          Row *row = new Row(_header);
 
-         for (; i != it->length(); i++)
-         {
-              if (it->at(i) == '"')
-                  quoted = ((quoted) ? (false) : (true));
-              else if (it->at(i) == ',' && !quoted)
-              {
-                  row->push(it->substr(tokenStart, i - tokenStart));
-                  tokenStart = i + 1;
-              }
-         }
+         // columns outside the projection are pushed empty, never copied
+         auto push = [&](const char *tokenEnd) {
+             if (isSelected(row->size()))
+                 row->push(std::string(tokenStart, tokenEnd - tokenStart));
+             else
+                 row->push(std::string());
+         };
+
+         scanDelimiters(line, line + it->length(), _sep,
+             [&](const char *sep) {
+                 push(sep);
+                 tokenStart = sep + 1;
+             },
+             [](const char *) {});
 
          //end
-         row->push(it->substr(tokenStart, it->length() - tokenStart));
+         push(line + it->length());
 
          // if value(s) missing
-         if (row->size() != _header.size())
+         if (row->size() != _header->size())
+         {
+          delete row;
           throw Error("corrupted data !");
+         }
          _content.push_back(row);
      }
   }
 
+  /*
+  ** eMMAP: walk the mapped buffer once and record every field as a slice
+  ** of it. Unlike the line-based modes, a newline inside a quoted field
+  ** does not end the record, and a trailing '\r' is not part of the data.
+  */
+  void Parser::indexContent(void)
+  {
+      const char *p = _map->data();
+      const char *end = p + _map->size();
+
+      // skip leading blank lines, then take the header line
+      while (p < end && (*p == '\n' || *p == '\r'))
+          p++;
+      if (p == end)
+        throw Error(std::string("No Data in ").append(_file));
+
+      const char *eol = p;
+      while (eol < end && *eol != '\n')
+          eol++;
+      const char *headerEnd = (eol > p && eol[-1] == '\r') ? eol - 1 : eol;
+      parseHeader(std::string(p, headerEnd - p));
+      p = (eol < end) ? eol + 1 : end;
+
+      unsigned int threads = indexThreads(_options.threads, end - p);
+      if (threads > 1)
+      {
+          indexParallel(p, end, threads);
+          return;
+      }
+
+      // size the field index from the first data line instead of growing it
+      const char *probe = p;
+      while (probe < end && *probe != '\n')
+          probe++;
+      if (probe > p)
+        _fields.reserve(((end - p) / (probe - p + 1) + 1) * _stride);
+
+      _rows = indexRange(p, end, _fields);
+  }
+
+  /*
+  ** Split [begin, end) at record boundaries into one byte range per
+  ** thread (see recordCuts) and index them concurrently
+  */
+  void Parser::indexParallel(const char *begin, const char *end, unsigned int threads)
+  {
+      _rows += indexRanges(recordCuts(begin, end, threads), _fields,
+          [this](const char *from, const char *to, std::vector<std::string_view> &out, bool) {
+              return indexRange(from, to, out);
+          });
+  }
+
+  unsigned int Parser::indexRange(const char *begin, const char *end,
+                                  std::vector<std::string_view> &fields) const
+  {
+      return indexRecords(begin, end, _sep, _header->size(),
+                          _slots.empty() ? nullptr : _slots.data(), fields);
+  }
+
   Row &Parser::getRow(unsigned int rowPosition) const
   {
+      if (_type == eMMAP)
+          throw Error("rows are not materialized in mmap mode (use getRowView)");
       if (rowPosition < _content.size())
           return *(_content[rowPosition]);
       throw Error("can't return this row (doesn't exist)");
   }
 
+  RowView Parser::getRowView(unsigned int rowPosition) const
+  {
+      if (_type != eMMAP)
+          throw Error("row views are only available in mmap mode");
+      if (rowPosition < _rows)
+          return RowView(&_fields[rowPosition * _stride], _header->size(), *_header,
+                         _slots.empty() ? nullptr : _slots.data());
+      throw Error("can't return this row (doesn't exist)");
+  }
+
   Row &Parser::operator[](unsigned int rowPosition) const
   {
       return Parser::getRow(rowPosition);
@@ -113,28 +663,32 @@ namespace csv {
 
   unsigned int Parser::rowCount(void) const
   {
+      if (_type == eMMAP)
+          return _rows;
       return _content.size();
   }
 
   unsigned int Parser::columnCount(void) const
   {
-      return _header.size();
+      return _header->size();
   }
 
-  std::vector<std::string> Parser::getHeader(void) const
+  const std::vector<std::string> &Parser::getHeader(void) const
   {
-      return _header;
+      return _header->names();
   }
 
-  const std::string Parser::getHeaderElement(unsigned int pos) const
+  const std::string &Parser::getHeaderElement(unsigned int pos) const
   {
-      if (pos >= _header.size())
+      if (pos >= _header->size())
         throw Error("can't return this header (doesn't exist)");
-      return _header[pos];
+      return (*_header)[pos];
   }
 
   bool Parser::deleteRow(unsigned int pos)
   {
+    if (_type == eMMAP)
+      return false;
     if (pos < _content.size())
     {
       delete *(_content.begin() + pos);
@@ -146,6 +700,9 @@ namespace csv {
 
   bool Parser::addRow(unsigned int pos, const std::vector<std::string> &r)
   {
+    if (_type == eMMAP)
+      return false;
+
     Row *row = new Row(_header);
 
     for (auto it = r.begin(); it != r.end(); it++)
@@ -163,23 +720,26 @@ namespace csv {
   {
     if (_type == DataType::eFILE)
     {
+      // One large buffer and plain newlines: std::endl would flush per row
+      std::vector<char> buffer(1 << 20);
       std::ofstream f;
+      f.rdbuf()->pubsetbuf(buffer.data(), static_cast<std::streamsize>(buffer.size()));
       f.open(_file, std::ios::out | std::ios::trunc);
 
       // header
       unsigned int i = 0;
-      for (auto it = _header.begin(); it != _header.end(); it++)
+      for (auto it = _header->names().begin(); it != _header->names().end(); it++)
       {
         f << *it;
-        if (i < _header.size() - 1)
+        if (i < _header->size() - 1)
           f << ",";
         else
-          f << std::endl;
+          f << '\n';
         i++;
       }
      
       for (auto it = _content.begin(); it != _content.end(); it++)
-        f << **it << std::endl;
+        f << **it << '\n';
       f.close();
     }
   }
@@ -188,13 +748,446 @@ namespace csv {
   {
       return _file;    
   }
-  
+
+  bool Parser::isSelected(unsigned int pos) const
+  {
+      return _slots.empty() ? pos < _header->size() : (pos < _slots.size() && _slots[pos] >= 0);
+  }
+
+  /*
+  ** NUMBERS
+  */
+
+  /*
+  ** Reduce text to what std::from_chars accepts: an optional '-' then the
+  ** digits, '.' and exponent. Blanks and one pair of quotes around the
+  ** value, a '$' before or after the sign, a leading '+' and thousands
+  ** separators in the integer part are dropped; anything else is invalid.
+  */
+  NumberStatus cleanNumber(std::string_view text, char *out, size_t capacity, size_t &length)
+  {
+      auto trim = [](std::string_view &s) {
+          while (!s.empty() && (s.front() == ' ' || s.front() == '\t' || s.front() == '\r'))
+              s.remove_prefix(1);
+          while (!s.empty() && (s.back() == ' ' || s.back() == '\t' || s.back() == '\r'))
+              s.remove_suffix(1);
+      };
+
+      trim(text);
+      if (text.size() >= 2 && text.front() == '"' && text.back() == '"')
+      {
+          text = text.substr(1, text.size() - 2);
+          trim(text);
+      }
+      if (text.empty())
+          return eNUMBER_EMPTY;
+
+      size_t i = 0;
+      bool negative = false;
+      bool sign = false;
+      bool currency = false;
+      for (; i < text.size(); i++)
+      {
+          if (!sign && (text[i] == '-' || text[i] == '+'))
+          {
+              negative = text[i] == '-';
+              sign = true;
+          }
+          else if (!currency && text[i] == '$')
+              currency = true;
+          else
+              break;
+      }
+
+      length = 0;
+      if (negative)
+          out[length++] = '-';
+
+      bool digits = false;
+      bool fraction = false;   // past '.' or into the exponent: no more separators
+      for (; i < text.size(); i++)
+      {
+          const char c = text[i];
+          if (c == ',' && digits && !fraction)
+              continue;
+          if (c >= '0' && c <= '9')
+              digits = true;
+          else if (c == '.' || c == 'e' || c == 'E')
+              fraction = true;
+          else if (!((c == '-' || c == '+') && length > 0 &&
+                     (out[length - 1] == 'e' || out[length - 1] == 'E')))
+              return eNUMBER_INVALID;
+          if (length == capacity)
+              return eNUMBER_RANGE;
+          out[length++] = c;
+      }
+      return digits ? eNUMBER_OK : eNUMBER_INVALID;
+  }
+
+  /*
+  ** MAPPED FILE
+  */
+
+  MappedFile::MappedFile(const std::string &path)
+      : _data(nullptr), _size(0)
+  {
+#ifdef _WIN32
+      HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL,
+                                OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+      if (file == INVALID_HANDLE_VALUE)
+        throw Error(std::string("Failed to open ").append(path));
+
+      LARGE_INTEGER length;
+      if (!GetFileSizeEx(file, &length))
+      {
+        CloseHandle(file);
+        throw Error(std::string("Failed to stat ").append(path));
+      }
+      _size = static_cast<size_t>(length.QuadPart);
+
+      if (_size > 0)
+      {
+        HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        CloseHandle(file);
+        if (mapping == NULL)
+          throw Error(std::string("Failed to map ").append(path));
+        void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+        if (view == NULL)
+          throw Error(std::string("Failed to map ").append(path));
+        _data = static_cast<const char *>(view);
+      }
+      else
+        CloseHandle(file);
+#else
+      int fd = ::open(path.c_str(), O_RDONLY);
+      if (fd < 0)
+        throw Error(std::string("Failed to open ").append(path));
+
+      struct stat st;
+      if (::fstat(fd, &st) != 0)
+      {
+        ::close(fd);
+        throw Error(std::string("Failed to stat ").append(path));
+      }
+      _size = static_cast<size_t>(st.st_size);
+
+      if (_size > 0)
+      {
+        void *view = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (view == MAP_FAILED)
+          throw Error(std::string("Failed to map ").append(path));
+        ::madvise(view, _size, MADV_SEQUENTIAL);
+        _data = static_cast<const char *>(view);
+      }
+      else
+        ::close(fd);
+#endif
+  }
+
+  MappedFile::~MappedFile(void)
+  {
+      if (_data == nullptr)
+          return;
+#ifdef _WIN32
+      UnmapViewOfFile(_data);
+#else
+      ::munmap(const_cast<char *>(_data), _size);
+#endif
+  }
+
+  const char *MappedFile::data(void) const
+  {
+      return _data;
+  }
+
+  size_t MappedFile::size(void) const
+  {
+      return _size;
+  }
+
+  std::string_view MappedFile::view(void) const
+  {
+      return std::string_view(_data, _size);
+  }
+
+  /*
+  ** STREAMING READER
+  */
+
+  Reader::Reader(const std::string &file, char sep, const Options &options, size_t bufferSize)
+      : _file(file), _sep(sep), _options(options), _stride(0),
+        _buffer(std::max<size_t>(bufferSize, 64)), _begin(0), _end(0), _eof(false),
+        _batchRows(0), _current(0), _rows(0)
+  {
+      _stream.open(_file.c_str(), std::ios::in | std::ios::binary);
+      if (!_stream.is_open())
+        throw Error(std::string("Failed to open ").append(_file));
+
+      // header: first non-blank line
+      std::string line;
+      while (std::getline(_stream, line))
+      {
+          if (!line.empty() && line[line.length() - 1] == '\r')
+              line.erase(line.length() - 1);
+          if (line != "")
+              break;
+      }
+      if (line == "")
+        throw Error(std::string("No Data in ").append(_file));
+
+      std::stringstream ss(line);
+      std::string item;
+      std::vector<std::string> names;
+      while (std::getline(ss, item, _sep))
+          names.push_back(item);
+      _header = std::make_shared<const Header>(names);
+      resolveSlots(_header->names(), _options, _slots, _stride);
+  }
+
+  bool Reader::next(RowView &row)
+  {
+      while (_current == _batchRows)
+          if (!fill())
+              return false;
+
+      row = RowView(&_fields[_current * _stride], _header->size(), *_header,
+                    _slots.empty() ? nullptr : _slots.data());
+      _current++;
+      _rows++;
+      return true;
+  }
+
+  /*
+  ** Carry the unconsumed tail (a partial record) to the front of the
+  ** buffer, top the buffer up from the file and index the next window.
+  */
+  bool Reader::fill(void)
+  {
+      if (_eof && _begin == _end)
+          return false;
+
+      std::memmove(_buffer.data(), _buffer.data() + _begin, _end - _begin);
+      _end -= _begin;
+      _begin = 0;
+
+      if (!_eof)
+      {
+          // a single record fills the buffer: make room for the rest of it
+          if (_end == _buffer.size())
+              _buffer.resize(_buffer.size() * 2);
+          _stream.read(_buffer.data() + _end, _buffer.size() - _end);
+          _end += static_cast<size_t>(_stream.gcount());
+          if (!_stream)
+              _eof = true;
+      }
+
+      const char *base = _buffer.data();
+      const int *slots = _slots.empty() ? nullptr : _slots.data();
+      _fields.clear();
+      _current = 0;
+      if (_eof)
+      {
+          _batchRows = indexRecords(base, base + _end, _sep, _header->size(), slots, _fields);
+          _begin = _end;
+      }
+      else
+      {
+          const char *complete;
+          _batchRows = indexRecords(base, base + _end, _sep, _header->size(), slots, _fields,
+                                    &complete);
+          _begin = complete - base;
+      }
+      return true;
+  }
+
+  unsigned int Reader::columnCount(void) const
+  {
+      return _header->size();
+  }
+
+  const std::vector<std::string> &Reader::getHeader(void) const
+  {
+      return _header->names();
+  }
+
+  unsigned long long Reader::rowsRead(void) const
+  {
+      return _rows;
+  }
+
+  const std::string &Reader::getFileName(void) const
+  {
+      return _file;
+  }
+
+  /*
+  ** TOKENIZER
+  */
+
+  Tokenizer::Tokenizer(char sep, const Options &options)
+      : _sep(sep), _options(options), _stride(0)
+  {
+  }
+
+  void Tokenizer::setHeader(const std::string &line)
+  {
+      std::string text(line);
+      if (!text.empty() && text[text.length() - 1] == '\r')
+          text.erase(text.length() - 1);
+      if (text == "")
+        throw Error("empty header");
+
+      std::stringstream ss(text);
+      std::string item;
+      std::vector<std::string> names;
+      while (std::getline(ss, item, _sep))
+          names.push_back(item);
+      _header = std::make_shared<const Header>(names);
+      resolveSlots(_header->names(), _options, _slots, _stride);
+  }
+
+  const std::vector<std::string> &Tokenizer::getHeader(void) const
+  {
+      if (!_header)
+        throw Error("no header set");
+      return _header->names();
+  }
+
+  unsigned int Tokenizer::columnCount(void) const
+  {
+      return _header ? _header->size() : 0;
+  }
+
+  unsigned int Tokenizer::stride(void) const
+  {
+      return _stride;
+  }
+
+  /*
+  ** Appends the kept fields of every record of [begin, end) to fields and
+  ** returns the number of records. With complete, the input may stop in
+  ** the middle of a record, whose start is stored there; without it, the
+  ** input is taken to end with the file.
+  **
+  ** With Options::threads other than 1, a piece of over minParallelChunk
+  ** bytes is split at record boundaries (see recordCuts) and its ranges
+  ** indexed concurrently; only the last range can hold the partial record.
+  */
+  unsigned int Tokenizer::index(const char *begin, const char *end,
+                                std::vector<std::string_view> &fields,
+                                const char **complete) const
+  {
+      if (!_header)
+        throw Error("no header set");
+      const size_t columns = _header->size();
+      const int *slots = _slots.empty() ? nullptr : _slots.data();
+
+      unsigned int threads = indexThreads(_options.threads, end - begin);
+      if (threads < 2)
+          return indexRecords(begin, end, _sep, columns, slots, fields, complete);
+
+      // cuts that ran into the end would leave the unfinished record
+      // outside the last range, so drop their empty ranges
+      std::vector<const char *> cuts = recordCuts(begin, end, threads);
+      while (cuts.size() > 2 && cuts[cuts.size() - 2] == end)
+          cuts.erase(cuts.end() - 2);
+      return indexRanges(cuts, fields,
+          [&](const char *from, const char *to, std::vector<std::string_view> &out, bool last) {
+              return indexRecords(from, to, _sep, columns, slots, out, last ? complete : nullptr);
+          });
+  }
+
+  RowView Tokenizer::row(const std::string_view *fields) const
+  {
+      return RowView(fields, _header->size(), *_header,
+                     _slots.empty() ? nullptr : _slots.data());
+  }
+
+  /*
+  ** ROW VIEW
+  */
+
+  RowView::RowView(void)
+      : _fields(nullptr), _size(0), _header(nullptr), _slots(nullptr) {}
+
+  RowView::RowView(const std::string_view *fields, unsigned int size,
+                   const Header &header, const int *slots)
+      : _fields(fields), _size(size), _header(&header), _slots(slots) {}
+
+  unsigned int RowView::size(void) const
+  {
+    return _size;
+  }
+
+  std::string_view RowView::operator[](unsigned int valuePosition) const
+  {
+       if (valuePosition >= _size)
+           throw Error("can't return this value (doesn't exist)");
+       if (_slots == nullptr)
+           return _fields[valuePosition];
+       if (_slots[valuePosition] < 0)
+           throw Error("can't return this value (not selected)");
+       return _fields[_slots[valuePosition]];
+  }
+
+  std::string_view RowView::operator[](const std::string &key) const
+  {
+      const int pos = (_header == nullptr) ? -1 : _header->find(key);
+      if (pos < 0)
+          throw Error("can't return this value (doesn't exist)");
+      return (*this)[pos];
+  }
+
+  /*
+  ** HEADER
+  */
+
+  Header::Header(const std::vector<std::string> &names)
+      : _names(names)
+  {
+      _positions.reserve(_names.size());
+      for (unsigned int i = 0; i < _names.size(); i++)
+          _positions.emplace(_names[i], i);
+  }
+
+  unsigned int Header::size(void) const
+  {
+      return _names.size();
+  }
+
+  const std::vector<std::string> &Header::names(void) const
+  {
+      return _names;
+  }
+
+  const std::string &Header::operator[](unsigned int pos) const
+  {
+      return _names[pos];
+  }
+
+  int Header::find(const std::string &name) const
+  {
+      std::unordered_map<std::string, unsigned int>::const_iterator it = _positions.find(name);
+      return (it == _positions.end()) ? -1 : static_cast<int>(it->second);
+  }
+
   /*
   ** ROW
   */
 
+  Row::Row(const std::shared_ptr<const Header> &header)
+      : _header(header)
+  {
+      _values.reserve(_header->size());
+  }
+
   Row::Row(const std::vector<std::string> &header)
-      : _header(header) {}
+      : _header(std::make_shared<const Header>(header))
+  {
+      _values.reserve(_header->size());
+  }
 
   Row::~Row(void) {}
 
@@ -208,43 +1201,35 @@ namespace csv {
     _values.push_back(value);
   }
 
+  void Row::push(std::string &&value)
+  {
+    _values.push_back(std::move(value));
+  }
+
   bool Row::set(const std::string &key, const std::string &value) 
   {
-    std::vector<std::string>::const_iterator it;
-    int pos = 0;
+    const int pos = _header->find(key);
 
-    for (it = _header.begin(); it != _header.end(); it++)
-    {
-        if (key == *it)
-        {
-          _values[pos] = value;
-          return true;
-        }
-        pos++;
-    }
-    return false;
+    if (pos < 0 || static_cast<unsigned int>(pos) >= _values.size())
+      return false;
+    _values[pos] = value;
+    return true;
   }
 
-  const std::string Row::operator[](unsigned int valuePosition) const
+  const std::string &Row::operator[](unsigned int valuePosition) const
   {
        if (valuePosition < _values.size())
            return _values[valuePosition];
        throw Error("can't return this value (doesn't exist)");
   }
 
-  const std::string Row::operator[](const std::string &key) const
+  const std::string &Row::operator[](const std::string &key) const
   {
-      std::vector<std::string>::const_iterator it;
-      int pos = 0;
+      const int pos = _header->find(key);
 
-      for (it = _header.begin(); it != _header.end(); it++)
-      {
-          if (key == *it)
-              return _values[pos];
-          pos++;
-      }
-      
-      throw Error("can't return this value (doesn't exist)");
+      if (pos < 0 || static_cast<unsigned int>(pos) >= _values.size())
+        throw Error("can't return this value (doesn't exist)");
+      return _values[pos];
   }
 
   std::ostream &operator<<(std::ostream &os, const Row &row)
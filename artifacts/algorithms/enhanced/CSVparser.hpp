@@ -6,6 +6,14 @@
 # include <vector>
 # include <list>
 # include <sstream>
+# include <fstream>
+# include <iterator>
+# include <string_view>
+# include <memory>
+# include <charconv>
+# include <system_error>
+# include <type_traits>
+# include <unordered_map>
 
 namespace csv
 {
@@ -19,29 +27,96 @@ namespace csv
         }
     };
 
+    /*
+    ** Allocation-free numeric conversion. Field text may carry the
+    ** decoration found in exports -- surrounding quotes and blanks, a
+    ** leading '$', thousands separators ("$3,000 ") -- which is stripped
+    ** into a stack buffer before std::from_chars. Failures come back as a
+    ** status and leave the output untouched; nothing throws.
+    */
+    enum NumberStatus {
+        eNUMBER_OK = 0,
+        eNUMBER_EMPTY = 1,
+        eNUMBER_INVALID = 2,
+        eNUMBER_RANGE = 3
+    };
+
+    NumberStatus cleanNumber(std::string_view, char *, size_t, size_t &);
+
+    template<typename T>
+    NumberStatus toNumber(std::string_view text, T &value)
+    {
+        static_assert(std::is_arithmetic<T>::value && !std::is_same<T, bool>::value,
+                      "toNumber needs a numeric type");
+        char buffer[128];
+        size_t length = 0;
+        NumberStatus status = cleanNumber(text, buffer, sizeof(buffer), length);
+        if (status != eNUMBER_OK)
+            return status;
+
+        T result;
+        std::from_chars_result r = std::from_chars(buffer, buffer + length, result);
+        if (r.ec == std::errc::result_out_of_range)
+            return eNUMBER_RANGE;
+        if (r.ec != std::errc() || r.ptr != buffer + length)
+            return eNUMBER_INVALID;
+        value = result;
+        return eNUMBER_OK;
+    }
+
+    /*
+    ** Immutable column names, built once per file and shared by all of its
+    ** rows. Name lookups go through a hash map; on duplicate names the
+    ** first column wins, as the linear scans did.
+    */
+    class Header
+    {
+    public:
+        Header(const std::vector<std::string> &);
+
+    public:
+        unsigned int size(void) const;
+        const std::vector<std::string> &names(void) const;
+        const std::string &operator[](unsigned int) const;
+        int find(const std::string &) const;   // position, or -1
+
+    private:
+        const std::vector<std::string> _names;
+        std::unordered_map<std::string, unsigned int> _positions;
+    };
+
     class Row
     {
     	public:
+    	    Row(const std::shared_ptr<const Header> &);
     	    Row(const std::vector<std::string> &);
     	    ~Row(void);
 
     	public:
             unsigned int size(void) const;
             void push(const std::string &);
+            void push(std::string &&);
             bool set(const std::string &, const std::string &); 
 
     	private:
-    		const std::vector<std::string> _header;
+    		const std::shared_ptr<const Header> _header;
     		std::vector<std::string> _values;
 
         public:
 
+            // numbers take the toNumber() path; anything it rejects, and
+            // every other type, still goes through stream extraction
             template<typename T>
             const T getValue(unsigned int pos) const
             {
                 if (pos < _values.size())
                 {
                     T res;
+                    if constexpr (std::is_arithmetic<T>::value && !std::is_same<T, bool>::value)
+                    {
+                        if (toNumber(_values[pos], res) == eNUMBER_OK)
+                            return res;
+                    }
                     std::stringstream ss;
                     ss << _values[pos];
                     ss >> res;
@@ -49,31 +124,118 @@ namespace csv
                 }
                 throw Error("can't return this value (doesn't exist)");
             }
-            const std::string operator[](unsigned int) const;
-            const std::string operator[](const std::string &valueName) const;
+
+            template<typename T>
+            NumberStatus getNumber(unsigned int pos, T &value) const
+            {
+                if (pos < _values.size())
+                    return toNumber(_values[pos], value);
+                throw Error("can't return this value (doesn't exist)");
+            }
+            const std::string &operator[](unsigned int) const;
+            const std::string &operator[](const std::string &valueName) const;
             friend std::ostream& operator<<(std::ostream& os, const Row &row);
             friend std::ofstream& operator<<(std::ofstream& os, const Row &row);
     };
 
+    /*
+    ** Read-only view of a file mapped into memory. The mapping is released
+    ** when the object is destroyed; views handed out must not outlive it.
+    ** The file may be renamed over or deleted while mapped (on Windows it is
+    ** opened with FILE_SHARE_DELETE); the mapping keeps the old contents.
+    */
+    class MappedFile
+    {
+    public:
+        MappedFile(const std::string &);
+        ~MappedFile(void);
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+
+    public:
+        const char *data(void) const;
+        size_t size(void) const;
+        std::string_view view(void) const;
+
+    private:
+        const char *_data;
+        size_t _size;
+    };
+
+    /*
+    ** Lightweight row accessor used by the eMMAP mode. It does not own
+    ** anything: fields are slices of the mapped file, kept by the Parser.
+    ** Positions are always those of the file; with a projection, slots maps
+    ** them to the stored fields (-1 for columns that were not kept).
+    */
+    class RowView
+    {
+    public:
+        RowView(void);
+        RowView(const std::string_view *, unsigned int, const Header &,
+                const int *slots = nullptr);
+
+    public:
+        unsigned int size(void) const;
+        std::string_view operator[](unsigned int) const;
+        std::string_view operator[](const std::string &valueName) const;
+
+        template<typename T>
+        NumberStatus getNumber(unsigned int pos, T &value) const
+        {
+            return toNumber((*this)[pos], value);
+        }
+
+    private:
+        const std::string_view *_fields;
+        unsigned int _size;
+        const Header *_header;
+        const int *_slots;
+    };
+
     enum DataType {
         eFILE = 0,
-        ePURE = 1
+        ePURE = 1,
+        eMMAP = 2   // zero-copy: fields are std::string_view into a mapped file
+    };
+
+    /*
+    ** Parse tuning. Threads only apply to the buffer-based (eMMAP) engine
+    ** and Tokenizer; the column projection applies to every mode.
+    */
+    struct Options
+    {
+        Options(void) : threads(1) {}
+
+        // Keep only the selected columns (all of them when nothing is
+        // selected). Other columns are still counted for validation but
+        // never stored: eMMAP rows don't index them and legacy rows hold
+        // an empty string in their place.
+        Options &select(unsigned int column) { columns.push_back(column); return *this; }
+        Options &select(const std::string &name) { columnNames.push_back(name); return *this; }
+
+        unsigned int threads;                   // worker threads for indexing, 0 = one per core
+        std::vector<unsigned int> columns;      // projection by position
+        std::vector<std::string> columnNames;   // projection by header name
     };
 
     class Parser
     {
 
     public:
-        Parser(const std::string &, const DataType &type = eFILE, char sep = ',');
+        Parser(const std::string &, const DataType &type = eFILE, char sep = ',',
+               const Options &options = Options());
         ~Parser(void);
 
     public:
         Row &getRow(unsigned int row) const;
+        RowView getRowView(unsigned int row) const;
         unsigned int rowCount(void) const;
         unsigned int columnCount(void) const;
-        std::vector<std::string> getHeader(void) const;
-        const std::string getHeaderElement(unsigned int pos) const;
+        const std::vector<std::string> &getHeader(void) const;
+        const std::string &getHeaderElement(unsigned int pos) const;
         const std::string &getFileName(void) const;
+        bool isSelected(unsigned int pos) const;
 
     public:
         bool deleteRow(unsigned int row);
@@ -82,19 +244,143 @@ namespace csv
 
     protected:
     	void parseHeader(void);
+    	void parseHeader(const std::string &);
     	void parseContent(void);
+        void resolveProjection(void);
+        void indexContent(void);
+        void indexParallel(const char *, const char *, unsigned int);
+        unsigned int indexRange(const char *, const char *, std::vector<std::string_view> &) const;
 
     private:
         std::string _file;
         const DataType _type;
         const char _sep;
+        const Options _options;
         std::vector<std::string> _originalFile;
-        std::vector<std::string> _header;
+        std::shared_ptr<const Header> _header;
         std::vector<Row *> _content;
+        std::unique_ptr<MappedFile> _map;
+        std::vector<int> _slots;                 // per column: stored position, -1 if skipped
+        unsigned int _stride;                    // stored fields per row
+        std::vector<std::string_view> _fields;   // eMMAP: rowCount() * _stride slices
+        unsigned int _rows;
 
     public:
         Row &operator[](unsigned int row) const;
     };
+
+    /*
+    ** Forward-only reader for inputs too large to hold: records are indexed
+    ** out of a fixed-size read buffer a window at a time and handed out as
+    ** RowViews, valid until the next call to next(). Memory stays at the
+    ** buffer plus one window of field slices whatever the file size; the
+    ** buffer only grows if a single record does not fit in it.
+    **
+    **   csv::Reader reader("bids.csv");
+    **   for (const csv::RowView &row : reader) ...
+    */
+    class Reader
+    {
+    public:
+        Reader(const std::string &, char sep = ',', const Options &options = Options(),
+               size_t bufferSize = 1 << 16);
+        Reader(const Reader &) = delete;
+        Reader &operator=(const Reader &) = delete;
+
+    public:
+        bool next(RowView &);
+        unsigned int columnCount(void) const;
+        const std::vector<std::string> &getHeader(void) const;
+        unsigned long long rowsRead(void) const;
+        const std::string &getFileName(void) const;
+
+    public:
+        class iterator
+        {
+        public:
+            typedef std::input_iterator_tag iterator_category;
+            typedef RowView value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef const RowView *pointer;
+            typedef const RowView &reference;
+
+            iterator(void) : _reader(nullptr) {}
+            explicit iterator(Reader *reader) : _reader(reader) { ++(*this); }
+
+            reference operator*(void) const { return _row; }
+            pointer operator->(void) const { return &_row; }
+            iterator &operator++(void)
+            {
+                if (_reader != nullptr && !_reader->next(_row))
+                    _reader = nullptr;
+                return *this;
+            }
+            bool operator==(const iterator &other) const { return _reader == other._reader; }
+            bool operator!=(const iterator &other) const { return _reader != other._reader; }
+
+        private:
+            Reader *_reader;
+            RowView _row;
+        };
+
+        iterator begin(void) { return iterator(this); }
+        iterator end(void) { return iterator(); }
+
+    protected:
+        bool fill(void);
+
+    private:
+        std::string _file;
+        const char _sep;
+        const Options _options;
+        std::ifstream _stream;
+        std::shared_ptr<const Header> _header;
+        std::vector<int> _slots;
+        unsigned int _stride;
+        std::vector<char> _buffer;
+        size_t _begin;                           // unconsumed bytes are [_begin, _end)
+        size_t _end;
+        bool _eof;
+        std::vector<std::string_view> _fields;   // current window
+        unsigned int _batchRows;
+        unsigned int _current;
+        unsigned long long _rows;
+    };
+
+    /*
+    ** Record indexer for callers that do their own reading, e.g. a loader
+    ** with I/O on another thread. Give it the header line, then consecutive
+    ** pieces of the file, each starting on a record boundary: index() keeps
+    ** the records a newline closes and reports where the unfinished one
+    ** starts, so the caller can put that in front of the next piece. Fields
+    ** are slices of the piece, laid out as Reader lays them out.
+    **
+    ** Once the header is set every member is const, so one thread may index
+    ** while another reads rows it indexed earlier. With Options::threads
+    ** other than 1, index() splits large pieces at record boundaries and
+    ** indexes them on that many threads, as Parser does a mapped file.
+    */
+    class Tokenizer
+    {
+    public:
+        Tokenizer(char sep = ',', const Options &options = Options());
+
+    public:
+        void setHeader(const std::string &);
+        const std::vector<std::string> &getHeader(void) const;
+        unsigned int columnCount(void) const;
+        unsigned int stride(void) const;     // fields index() stores per record
+        unsigned int index(const char *, const char *, std::vector<std::string_view> &,
+                           const char **complete = nullptr) const;
+        RowView row(const std::string_view *) const;
+
+    private:
+        const char _sep;
+        const Options _options;
+        std::shared_ptr<const Header> _header;
+        std::vector<int> _slots;
+        unsigned int _stride;
+    };
 }
 
 #endif /*!_CSVPARSER_HPP_*/
@@ -7,35 +7,49 @@
 //============================================================================
 
 #include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
 #include <iostream>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
 #include <iomanip>
 #include <limits>
 #include <stdexcept>
 
+#include "Benchmark.hpp"
+#include "BenchmarkRunner.hpp"
+#include "Bid.hpp"
+#include "BidGenerator.hpp"
+#include "BidIndex.hpp"
+#include "BidLoader.hpp"
+#include "BidSession.hpp"
+#include "BidSnapshot.hpp"
+#include "BidSorter.hpp"
+#include "BidWriter.hpp"
 #include "CSVparser.hpp"
+#include "ExternalSort.hpp"
+#include "Instrumentation.hpp"
+#include "SortSpec.hpp"
 
 using namespace std;
 using namespace std::chrono;
 
+// Compiler and optimization settings, for telling benchmark results of
+// different builds apart; the CMake build defines it
+#ifndef ENHANCED_SORTING_BUILD_INFO
+#define ENHANCED_SORTING_BUILD_INFO "Visual Studio project"
+#endif
+
 //============================================================================
 // Global definitions and structures
 //============================================================================
 
-/**
- * Structure to hold bid information
- */
-struct Bid {
-    string bidId;    // unique identifier
-    string title;    // bid title for sorting
-    string fund;     // fund information
-    double amount;   // bid amount
-
-    Bid() : amount(0.0) {}
-};
-
 /**
  * Structure to hold benchmark results for sorting algorithms
  */
@@ -43,275 +57,255 @@ struct BenchmarkResult {
     string algorithmName;
     size_t dataSize;
     double executionTimeMs;
+    string complexity;      // empty: looked up from the registry by name
+    PerfSample perf;        // hardware counters, when instrumentation is on
+    OpCounts ops;           // operation counts, when instrumentation is on
 
-    BenchmarkResult(const string& name, size_t size, double time)
-        : algorithmName(name), dataSize(size), executionTimeMs(time) {
+    BenchmarkResult(const string& name, size_t size, double time, const string& complexity = "")
+        : algorithmName(name), dataSize(size), executionTimeMs(time), complexity(complexity) {
     }
 };
 
-//============================================================================
-// Sorting Algorithms Class
-//============================================================================
-
 /**
- * Class containing various sorting algorithms for Bid objects
- * Provides modular, reusable sorting functionality with performance tracking
- */
-class BidSorter {
-private:
-    /**
-     * Partition function for quicksort algorithm
-     * Divides the vector into two parts around a pivot element
-     *
-     * @param bids Reference to vector of Bid objects to partition
-     * @param begin Starting index for partition
-     * @param end Ending index for partition
-     * @return Index of the partition point
-     */
-    static size_t partition(vector<Bid>& bids, size_t begin, size_t end) {
-        if (begin >= end) return begin;
-
-        size_t lowIndex = begin;
-        size_t highIndex = end;
-
-        // Use middle element as pivot to improve average case performance
-        size_t middlePoint = lowIndex + (highIndex - lowIndex) / 2;
-        string pivot = bids[middlePoint].title;
-
-        while (true) {
-            // Find element greater than or equal to pivot from left
-            while (lowIndex <= end && bids[lowIndex].title < pivot) {
-                lowIndex++;
-            }
-
-            // Find element less than or equal to pivot from right
-            while (highIndex >= begin && pivot < bids[highIndex].title) {
-                highIndex--;
-            }
-
-            // If pointers have crossed, partitioning is complete
-            if (highIndex <= lowIndex) {
-                return highIndex;
-            }
-
-            // Swap elements and continue
-            swap(bids[lowIndex], bids[highIndex]);
-            lowIndex++;
-            highIndex--;
-        }
-    }
-
-    /**
-     * Merge function for merge sort algorithm
-     * Combines two sorted subarrays into a single sorted array
-     *
-     * @param bids Reference to vector of Bid objects
-     * @param left Starting index of left subarray
-     * @param mid Ending index of left subarray
-     * @param right Ending index of right subarray
-     */
-    static void merge(vector<Bid>& bids, size_t left, size_t mid, size_t right) {
-        // Create temporary arrays for left and right subarrays
-        vector<Bid> leftArray(bids.begin() + left, bids.begin() + mid + 1);
-        vector<Bid> rightArray(bids.begin() + mid + 1, bids.begin() + right + 1);
-
-        size_t i = 0, j = 0, k = left;
-
-        // Merge the temporary arrays back into bids[left..right]
-        while (i < leftArray.size() && j < rightArray.size()) {
-            if (leftArray[i].title <= rightArray[j].title) {
-                bids[k] = leftArray[i];
-                i++;
-            }
-            else {
-                bids[k] = rightArray[j];
-                j++;
-            }
-            k++;
-        }
-
-        // Copy remaining elements of leftArray, if any
-        while (i < leftArray.size()) {
-            bids[k] = leftArray[i];
-            i++;
-            k++;
-        }
+ * Registry entry for an algorithm that sorts a whole vector of bids
+ */
+struct SortAlgorithm {
+    string name;
+    string complexity;
+    function<void(vector<Bid>&, const SortSpec&)> sort;
+    bool quadratic = false;     // O(n): left out of scaling sweeps past QUADRATIC_SWEEP_LIMIT
+    // Comparisons and moves of one counted, untimed run; empty for
+    // algorithms that are not generic over the element type
+    function<OpCounts(const vector<Bid>&, const SortSpec&)> countOps{};
+    bool parallel = false;      // forks onto ThreadPool::shared(): kept apart in concurrent benchmarks
+    // Orders the algorithm sorts by its own method; it hands any other to
+    // the comparison sort named by fallback. Empty: every order.
+    function<bool(const SortSpec&)> applies{};
+    string fallback{};
+};
 
-        // Copy remaining elements of rightArray, if any
-        while (j < rightArray.size()) {
-            bids[k] = rightArray[j];
-            j++;
-            k++;
-        }
+/**
+ * Name a run of algorithm by spec is reported under: the registry name,
+ * plus the [fallback] sort when spec is not one the algorithm handles
+ * itself, so that row is not read as timing the algorithm's own method
+ *
+ * @param algorithm Registered algorithm
+ * @param spec Order it sorts by
+ */
+string runName(const SortAlgorithm& algorithm, const SortSpec& spec) {
+    if (algorithm.applies && !algorithm.applies(spec)) {
+        return algorithm.name + " [" + algorithm.fallback + "]";
     }
+    return algorithm.name;
+}
 
-public:
-    /**
-     * Selection Sort Algorithm
-     * Time Complexity: O(n) average and worst case
-     * Space Complexity: O(1)
-     *
-     * @param bids Reference to vector of Bid objects to sort
-     */
-    static void selectionSort(vector<Bid>& bids) {
-        if (bids.empty()) return;
-
-        size_t size = bids.size();
-
-        for (size_t i = 0; i < size - 1; ++i) {
-            size_t minIndex = i;
-
-            // Find the minimum element in remaining unsorted array
-            for (size_t j = i + 1; j < size; ++j) {
-                if (bids[j].title < bids[minIndex].title) {
-                    minIndex = j;
-                }
-            }
-
-            // Swap the found minimum element with the first element
-            if (minIndex != i) {
-                swap(bids[i], bids[minIndex]);
-            }
-        }
+/**
+ * @return Complexity of a run of algorithm by spec: that of its fallback
+ *         comparison sort when spec is one it does not handle itself
+ */
+string runComplexity(const SortAlgorithm& algorithm, const SortSpec& spec) {
+    if (algorithm.applies && !algorithm.applies(spec)) {
+        return "O(n log n)";
     }
+    return algorithm.complexity;
+}
 
-    /**
-     * Quick Sort Algorithm (Recursive Implementation)
-     * Time Complexity: O(n log n) average case, O(n) worst case
-     * Space Complexity: O(log n) average case due to recursion
-     *
-     * @param bids Reference to vector of Bid objects to sort
-     * @param begin Starting index for sorting
-     * @param end Ending index for sorting
-     */
-    static void quickSort(vector<Bid>& bids, size_t begin, size_t end) {
-        if (bids.empty() || end <= begin) return;
-
-        // Partition the array and get the pivot index
-        size_t pivotIndex = partition(bids, begin, end);
-
-        // Recursively sort elements before and after partition
-        if (pivotIndex > begin) {
-            quickSort(bids, begin, pivotIndex);
-        }
-        if (pivotIndex < end) {
-            quickSort(bids, pivotIndex + 1, end);
-        }
-    }
-
-    /**
-     * Merge Sort Algorithm (Recursive Implementation)
-     * Time Complexity: O(n log n) guaranteed
-     * Space Complexity: O(n) for temporary arrays
-     *
-     * @param bids Reference to vector of Bid objects to sort
-     * @param left Starting index for sorting
-     * @param right Ending index for sorting
-     */
-    static void mergeSort(vector<Bid>& bids, size_t left, size_t right) {
-        if (bids.empty() || left >= right) return;
-
-        // Find the middle point to divide the array into two halves
-        size_t mid = left + (right - left) / 2;
-
-        // Recursively sort first and second halves
-        mergeSort(bids, left, mid);
-        mergeSort(bids, mid + 1, right);
-
-        // Merge the sorted halves
-        merge(bids, left, mid, right);
-    }
-
-    /**
-     * Heap Sort Algorithm
-     * Time Complexity: O(n log n) guaranteed
-     * Space Complexity: O(1)
-     *
-     * @param bids Reference to vector of Bid objects to sort
-     */
-    static void heapSort(vector<Bid>& bids) {
-        if (bids.empty()) return;
-
-        // Lambda function to heapify a subtree rooted at index i
-        auto heapify = [&bids](size_t n, size_t i) {
-            auto heapifyRecursive = [&bids](size_t n, size_t i, auto& self) -> void {
-                size_t largest = i;    // Initialize largest as root
-                size_t left = 2 * i + 1;   // left child
-                size_t right = 2 * i + 2;  // right child
-
-                // If left child is larger than root
-                if (left < n && bids[left].title > bids[largest].title) {
-                    largest = left;
-                }
-
-                // If right child is larger than largest so far
-                if (right < n && bids[right].title > bids[largest].title) {
-                    largest = right;
-                }
-
-                // If largest is not root
-                if (largest != i) {
-                    swap(bids[i], bids[largest]);
-                    // Recursively heapify the affected sub-tree
-                    self(n, largest, self);
-                }
-                };
-            heapifyRecursive(n, i, heapifyRecursive);
-            };
-
-        size_t n = bids.size();
+/**
+ * Largest input a scaling sweep gives a quadratic algorithm; one more
+ * power of ten would take minutes per run
+ */
+const size_t QUADRATIC_SWEEP_LIMIT = 20000;
 
-        // Build heap (rearrange array)
-        for (int i = n / 2 - 1; i >= 0; i--) {
-            heapify(n, i);
+/**
+ * Wraps a generic BidSorter algorithm, called as algorithm(bids, less), as
+ * a registry entry. The comparator is BidSorter::withLess's pick: the
+ * specialized TitleLess or ThenBy instantiation for the common orders, the
+ * fused SortSpec comparator for any other.
+ */
+template<typename Algorithm>
+function<void(vector<Bid>&, const SortSpec&)> withSpec(Algorithm algorithm) {
+    return [algorithm](vector<Bid>& bids, const SortSpec& spec) {
+        if (bids.empty()) {
+            return;
         }
+        BidSorter::withLess(spec, [&](auto less) { algorithm(bids, less); });
+    };
+}
 
-        // Extract elements from heap one by one
-        for (size_t i = n - 1; i > 0; i--) {
-            // Move current root to end
-            swap(bids[0], bids[i]);
-
-            // Call max heapify on the reduced heap
-            heapify(i, 0);
+/**
+ * Registry entry for a generic BidSorter algorithm, called as
+ * algorithm(items, less) on any element type: it sorts bids through
+ * withSpec, and counts operations by sorting Counted<Bid> copies through a
+ * CountingLess
+ */
+template<typename Algorithm>
+SortAlgorithm genericAlgorithm(const string& name, const string& complexity, Algorithm algorithm,
+    bool quadratic = false, bool parallel = false) {
+    SortAlgorithm entry{ name, complexity, withSpec(algorithm), quadratic };
+    entry.parallel = parallel;
+    entry.countOps = [algorithm](const vector<Bid>& bids, const SortSpec& spec) {
+        vector<Counted<Bid>> items(bids.begin(), bids.end());
+        Instrumentation::Scope scope;
+        if (!items.empty()) {
+            BidSorter::withLess(spec, [&](auto less) {
+                algorithm(items, CountingLess<decltype(less)>(less));
+            });
         }
-    }
-};
+        return scope.counts();
+    };
+    return entry;
+}
+
+/**
+ * Returns every vector<Bid> sort, in the order the benchmark and the
+ * algorithm menu list them
+ *
+ * @return Registry of sort algorithms
+ */
+const vector<SortAlgorithm>& sortAlgorithms() {
+    static const vector<SortAlgorithm> algorithms = {
+        // Main menu options 4-7 run the first four entries
+        genericAlgorithm("Selection Sort", "O(n)",
+            [](auto& items, auto less) { BidSorter::selectionSortBy(items, less); }, true),
+        genericAlgorithm("Quick Sort", "O(n log n)",
+            [](auto& items, auto less) { BidSorter::quickSortBy(items, 0, items.size() - 1, less); }),
+        genericAlgorithm("Merge Sort", "O(n log n)",
+            [](auto& items, auto less) { BidSorter::mergeSortBy(items, 0, items.size() - 1, less); }),
+        genericAlgorithm("Heap Sort", "O(n log n)",
+            [](auto& items, auto less) { BidSorter::heapSortBy(items, less); }),
+        genericAlgorithm("Merge Sort (buffered)", "O(n log n)",
+            [](auto& items, auto less) { BidSorter::bufferedMergeSortBy(items, less); }),
+        genericAlgorithm("Tim Sort", "O(n log n)",
+            [](auto& items, auto less) { BidSorter::timSortBy(items, less); }),
+        genericAlgorithm("Intro Sort", "O(n log n)",
+            [](auto& items, auto less) { BidSorter::introSortBy(items, less); }),
+        { "Multikey Quick Sort", "O(n log n + D)", &BidSorter::multikeyQuickSort, false, {}, false,
+            &BidSorter::multikeyQuickSortApplies, "intro" },
+        { "Radix Sort (amount)", "O(n)", &BidSorter::radixSortByAmount, false, {}, false,
+            &BidSorter::radixSortApplies, "merge" },
+        { "Selection Sort (prefix keys)", "O(n)", &BidSorter::selectionSortKeyed, true },
+        { "Quick Sort (prefix keys)", "O(n log n)", &BidSorter::quickSortKeyed },
+        { "Merge Sort (prefix keys)", "O(n log n)", &BidSorter::mergeSortKeyed },
+        { "Heap Sort (prefix keys)", "O(n log n)", &BidSorter::heapSortKeyed },
+        genericAlgorithm("Parallel Quick Sort", "O(n log n)", [](auto& items, auto less) {
+            BidSorter::parallelQuickSortBy(items, less, ThreadPool::shared(), BidSorter::parallelCutoff());
+        }, false, true),
+        genericAlgorithm("Parallel Merge Sort", "O(n log n)", [](auto& items, auto less) {
+            BidSorter::parallelMergeSortBy(items, less, ThreadPool::shared(), BidSorter::parallelCutoff());
+        }, false, true),
+    };
+    return algorithms;
+}
 
 //============================================================================
 // Benchmarking and Utility Functions
 //============================================================================
 
+/**
+ * Times one call of run. With instrumentation on, also reads the hardware
+ * counters and counts the string copies and allocations of that call; the
+ * counters are started before and stopped after the clock, so they add
+ * nothing to it.
+ *
+ * @param run Work to time
+ * @param perf Receives the hardware counts, if instrumentation is on
+ * @param ops Receives the string copy and allocation counts, if
+ *        instrumentation is on
+ * @return Elapsed milliseconds
+ */
+template<typename Run>
+double timeRun(Run run, PerfSample& perf, OpCounts& ops) {
+    if (!Instrumentation::enabled()) {
+        auto start = steady_clock::now();
+        run();
+        auto end = steady_clock::now();
+        return duration<double, milli>(end - start).count();
+    }
+
+    PerfCounters counters;
+    Instrumentation::Scope scope;
+    counters.start();
+    auto start = steady_clock::now();
+    run();
+    auto end = steady_clock::now();
+    perf = counters.stop();
+
+    OpCounts counted = scope.counts();
+    ops.stringCopies = counted.stringCopies;
+    ops.allocations = counted.allocations;
+    ops.bytesAllocated = counted.bytesAllocated;
+    return duration<double, milli>(end - start).count();
+}
+
 /**
  * Benchmarks a sorting algorithm and returns execution time
  *
  * @param sortFunction Function pointer to the sorting algorithm
- * @param bids Vector of bids to sort (will be copied for testing)
+ * @param input Bids to sort; left as they are, the sort runs on a clone
  * @param algorithmName Name of the algorithm for reporting
+ * @param complexity Complexity to report, if the name is not registered
+ * @param coldCache true to flush the caches before the timed run
  * @return BenchmarkResult containing timing information
  */
 template<typename SortFunc>
-BenchmarkResult benchmarkSort(SortFunc sortFunction, vector<Bid> bids, const string& algorithmName) {
-    if (bids.empty()) {
-        return BenchmarkResult(algorithmName, 0, 0.0);
+BenchmarkResult benchmarkSort(SortFunc sortFunction, const vector<Bid>& input, const string& algorithmName,
+    const string& complexity = "", bool coldCache = false) {
+    if (input.empty()) {
+        return BenchmarkResult(algorithmName, 0, 0.0, complexity);
     }
 
-    auto start = high_resolution_clock::now();
-
-    // Execute the sorting algorithm
-    if constexpr (is_same_v<SortFunc, decltype(&BidSorter::quickSort)> ||
-        is_same_v<SortFunc, decltype(&BidSorter::mergeSort)>) {
-        // For algorithms that need begin/end parameters
-        sortFunction(bids, 0, bids.size() - 1);
+    // Clone for the benchmark, outside the timing: every algorithm starts
+    // from the same input. Bids are views, so no text is copied.
+    vector<Bid> bids(input);
+    if (coldCache) {
+        Benchmark::evictCaches();
     }
-    else {
-        // For algorithms that take only the vector
-        sortFunction(bids);
+
+    BenchmarkResult result(algorithmName, bids.size(), 0.0, complexity);
+    result.executionTimeMs = timeRun([&] {
+        // Execute the sorting algorithm
+        if constexpr (is_same_v<SortFunc, decltype(&BidSorter::quickSort)> ||
+            is_same_v<SortFunc, decltype(&BidSorter::mergeSort)>) {
+            // For algorithms that need begin/end parameters
+            sortFunction(bids, 0, bids.size() - 1);
+        }
+        else {
+            // For algorithms that take only the vector
+            sortFunction(bids);
+        }
+    }, result.perf, result.ops);
+    return result;
+}
+
+/**
+ * Benchmarks a columnar sort, which orders a permutation of table rows
+ * Building the table and the identity permutation is not timed
+ *
+ * @param sortFunction One of the BidSorter ...Table algorithms
+ * @param table Columnar copy of the bids
+ * @param algorithmName Name of the algorithm for reporting
+ * @param spec Order to sort the rows in
+ * @param coldCache true to flush the caches before the timed run
+ * @return BenchmarkResult containing timing information
+ */
+template<typename SortFunc>
+BenchmarkResult benchmarkTableSort(SortFunc sortFunction, const BidTable& table, const string& algorithmName,
+    const SortSpec& spec, bool coldCache = false) {
+    vector<uint32_t> order = table.identity();
+    if (coldCache) {
+        Benchmark::evictCaches();
     }
 
-    auto end = high_resolution_clock::now();
-    auto duration = duration_cast<microseconds>(end - start);
+    BenchmarkResult result(algorithmName, table.size(), 0.0);
+    result.executionTimeMs = timeRun([&] { sortFunction(table, order, spec); }, result.perf, result.ops);
+    return result;
+}
 
-    return BenchmarkResult(algorithmName, bids.size(), duration.count() / 1000.0);
+/**
+ * @return The count as text, or "n/a" if it was not collected (negative)
+ */
+string counterText(int64_t count) {
+    return (count < 0) ? string("n/a") : to_string(count);
 }
 
 /**
@@ -325,37 +319,115 @@ void displayBenchmarks(const vector<BenchmarkResult>& results) {
         return;
     }
 
-    cout << "\n" << string(70, '=') << endl;
+    cout << "\n" << string(80, '=') << endl;
     cout << "SORTING ALGORITHM PERFORMANCE COMPARISON" << endl;
-    cout << string(70, '=') << endl;
+    cout << string(80, '=') << endl;
 
-    cout << left << setw(20) << "Algorithm"
+    cout << left << setw(30) << "Algorithm"
         << setw(15) << "Data Size"
         << setw(20) << "Time (ms)"
         << setw(15) << "Complexity" << endl;
-    cout << string(70, '-') << endl;
+    cout << string(80, '-') << endl;
 
     for (const auto& result : results) {
-        string complexity;
-        if (result.algorithmName == "Selection Sort") {
-            complexity = "O(n)";
-        }
-        else if (result.algorithmName == "Quick Sort") {
-            complexity = "O(n log n)";
-        }
-        else if (result.algorithmName == "Merge Sort") {
-            complexity = "O(n log n)";
-        }
-        else if (result.algorithmName == "Heap Sort") {
-            complexity = "O(n log n)";
+        // An explicit complexity wins; otherwise take the longest registered
+        // name the result starts with, so variants share their base's
+        string complexity = result.complexity;
+        size_t matched = 0;
+        for (const auto& algorithm : sortAlgorithms()) {
+            const string& name = algorithm.name;
+            if (result.complexity.empty() && name.size() > matched &&
+                result.algorithmName.compare(0, name.size(), name) == 0) {
+                complexity = algorithm.complexity;
+                matched = name.size();
+            }
         }
 
-        cout << left << setw(20) << result.algorithmName
+        cout << left << setw(30) << result.algorithmName
             << setw(15) << result.dataSize
             << setw(20) << fixed << setprecision(3) << result.executionTimeMs
             << setw(15) << complexity << endl;
     }
-    cout << string(70, '=') << endl;
+    cout << string(80, '=') << endl;
+
+    if (!Instrumentation::enabled()) {
+        return;
+    }
+    cout << "\n" << string(150, '=') << endl;
+    cout << "OPERATION AND HARDWARE COUNTS (n/a: not collected or not available)" << endl;
+    cout << string(150, '=') << endl;
+    cout << left << setw(30) << "Algorithm" << right
+        << setw(13) << "Comparisons"
+        << setw(11) << "Copies"
+        << setw(11) << "Moves"
+        << setw(12) << "Str copies"
+        << setw(10) << "Alloc KB"
+        << setw(15) << "Cycles"
+        << setw(15) << "Instructions"
+        << setw(12) << "Cache miss"
+        << setw(12) << "Branch miss" << endl;
+    cout << string(150, '-') << endl;
+    for (const auto& result : results) {
+        cout << left << setw(30) << result.algorithmName << right
+            << setw(13) << counterText(result.ops.comparisons)
+            << setw(11) << counterText(result.ops.copies)
+            << setw(11) << counterText(result.ops.moves)
+            << setw(12) << counterText(result.ops.stringCopies)
+            << setw(10) << counterText(result.ops.bytesAllocated < 0 ? -1 : result.ops.bytesAllocated / 1024)
+            << setw(15) << counterText(result.perf.cycles)
+            << setw(15) << counterText(result.perf.instructions)
+            << setw(12) << counterText(result.perf.cacheMisses)
+            << setw(12) << counterText(result.perf.branchMisses) << endl;
+    }
+    cout << left << string(150, '=') << endl;
+}
+
+/**
+ * Prints the counters of a single instrumented run on two lines
+ *
+ * @param perf Hardware counts
+ * @param ops Operation counts
+ */
+void displayCounters(const PerfSample& perf, const OpCounts& ops) {
+    cout << "  cycles " << counterText(perf.cycles)
+        << ", instructions " << counterText(perf.instructions)
+        << ", cache misses " << counterText(perf.cacheMisses)
+        << ", branch misses " << counterText(perf.branchMisses) << endl;
+    cout << "  comparisons " << counterText(ops.comparisons)
+        << ", copies " << counterText(ops.copies)
+        << ", moves " << counterText(ops.moves)
+        << ", string copies " << counterText(ops.stringCopies)
+        << ", allocations " << counterText(ops.allocations)
+        << " (" << counterText(ops.bytesAllocated < 0 ? -1 : ops.bytesAllocated / 1024) << " KB)" << endl;
+}
+
+/**
+ * Displays repeated-run benchmark statistics in a formatted table
+ *
+ * @param results Statistics to display
+ */
+void displayBenchmarkStats(const vector<BenchmarkStats>& results) {
+    cout << "\n" << string(94, '=') << endl;
+    cout << "BENCHMARK SUITE RESULTS" << endl;
+    cout << string(94, '=') << endl;
+
+    cout << left << setw(30) << "Algorithm"
+        << right << setw(12) << "Min (ms)"
+        << setw(12) << "Median (ms)"
+        << setw(12) << "p95 (ms)"
+        << setw(12) << "Stddev (ms)"
+        << setw(16) << "Items/s" << endl;
+    cout << string(94, '-') << endl;
+
+    for (const auto& result : results) {
+        cout << left << setw(30) << result.name << right << fixed << setprecision(3)
+            << setw(12) << result.minMs
+            << setw(12) << result.medianMs
+            << setw(12) << result.p95Ms
+            << setw(12) << result.stddevMs
+            << setw(16) << setprecision(0) << result.itemsPerSecond() << endl;
+    }
+    cout << left << string(94, '=') << endl;
 }
 
 /**
@@ -384,54 +456,115 @@ int getValidatedInput(const string& prompt, int min = 1, int max = 10) {
 }
 
 /**
- * Converts string to double after removing specified character
+ * Converts a currency string such as "$3,000 " to a double
+ * Parses in place (no copy, no exceptions) via csv::toNumber
  *
  * @param str Input string to convert
- * @param ch Character to remove from string
- * @return Converted double value
+ * @return Converted double value, or 0.0 if the string is not a number
  */
-double strToDouble(string str, char ch) {
-    str.erase(remove(str.begin(), str.end(), ch), str.end());
-    try {
-        return stod(str);
-    }
-    catch (const invalid_argument& e) {
+double strToDouble(string_view str) {
+    double value = 0.0;
+    if (csv::toNumber(str, value) != csv::eNUMBER_OK) {
         return 0.0;
     }
+    return value;
 }
 
 /**
- * Displays bid information to console
+ * Displays the session's bids a page at a time, each page written in one
+ * piece, asking before every page after the first
  *
- * @param bid Bid object to display
+ * @param session Bids to display, in their current order
  */
-void displayBid(const Bid& bid) {
-    cout << bid.bidId << ": " << bid.title << " | $"
-        << fixed << setprecision(2) << bid.amount << " | " << bid.fund << endl;
+void displayBids(const BidSession& session) {
+    if (session.empty()) {
+        cout << "No bids to display. Please load data first." << endl;
+        return;
+    }
+    const vector<Bid>& bids = session.bids();
+    int total = static_cast<int>(min<size_t>(bids.size(), numeric_limits<int>::max()));
+    int first = getValidatedInput("Start at bid (1-" + to_string(total) + "): ", 1, total);
+    int page = getValidatedInput("Bids per page (0 = all): ", 0, total);
+    size_t pageSize = (page == 0) ? bids.size() : static_cast<size_t>(page);
+
+    cout << "\nDisplaying " << session.size() << " bids:" << endl;
+    cout << string(60, '-') << endl;
+    BidWriter writer(cout);
+    for (size_t start = static_cast<size_t>(first - 1); start < bids.size(); start += pageSize) {
+        writer.write(bids, start, pageSize);
+        writer.flush();
+        size_t shown = min(start + pageSize, bids.size());
+        if (shown == bids.size()) {
+            break;
+        }
+        cout << "-- " << (start + 1) << "-" << shown << " of " << bids.size()
+            << "; Enter for more, q to stop: ";
+        string answer;
+        if (!getline(cin, answer) || answer == "q" || answer == "Q") {
+            break;
+        }
+    }
+}
+
+/**
+ * Writes the session's bids, in their current order, to a CSV file that
+ * loads back like the original export
+ *
+ * @param session Bids to export
+ */
+void exportBids(const BidSession& session) {
+    if (session.empty()) {
+        cout << "No bids to export. Please load data first." << endl;
+        return;
+    }
+    cout << "File name [bids_sorted.csv]: ";
+    string path;
+    getline(cin, path);
+    if (path.empty()) {
+        path = "bids_sorted.csv";
+    }
+
+    auto start = steady_clock::now();
+    ofstream out(path, ios::binary | ios::trunc);
+    BidWriter writer(out, eCSV, 1 << 20);
+    writer.writeHeader();
+    writer.write(session.bids());
+    if (!writer.flush()) {
+        cerr << "Could not write " << path << "." << endl;
+        return;
+    }
+    auto end = steady_clock::now();
+    cout << "Exported " << writer.rows() << " bids to " << path << " in " << fixed << setprecision(3)
+        << duration<double, milli>(end - start).count() << " ms." << endl;
 }
 
 /**
  * Prompts user for bid information
  *
+ * @param arena Arena that takes ownership of the entered text
  * @return Bid object with user-entered information
  */
-Bid getBid() {
+Bid getBid(BidArena& arena) {
     Bid bid;
+    string line;
 
     cout << "Enter Id: ";
     cin.ignore();
-    getline(cin, bid.bidId);
+    getline(cin, line);
+    bid.bidId = arena.copy(line);
 
     cout << "Enter title: ";
-    getline(cin, bid.title);
+    getline(cin, line);
+    bid.title = arena.copy(line);
 
     cout << "Enter fund: ";
-    getline(cin, bid.fund);
+    getline(cin, line);
+    bid.fund = arena.intern(line);
 
     cout << "Enter amount: ";
     string strAmount;
     getline(cin, strAmount);
-    bid.amount = strToDouble(strAmount, '$');
+    bid.amount = strToDouble(strAmount);
 
     return bid;
 }
@@ -440,28 +573,29 @@ Bid getBid() {
  * Loads bids from CSV file
  *
  * @param csvPath Path to the CSV file
+ * @param arena Arena that takes ownership of the bid text
+ * @param stages Receives the time of each load stage, if given
  * @return Vector of Bid objects loaded from file
  */
-vector<Bid> loadBids(const string& csvPath) {
+vector<Bid> loadBids(const string& csvPath, BidArena& arena, LoadTimings* stages = nullptr) {
     cout << "Loading CSV file: " << csvPath << endl;
     vector<Bid> bids;
 
     try {
-        csv::Parser file(csvPath);
-
-        cout << "Processing " << file.rowCount() << " rows..." << endl;
-
-        for (int i = 0; i < file.rowCount(); i++) {
-            Bid bid;
-            bid.bidId = file[i][1];
-            bid.title = file[i][0];
-            bid.fund = file[i][8];
-            bid.amount = strToDouble(file[i][4], '$');
-
-            bids.push_back(bid);
+        // Reading, tokenizing and building bids run as overlapping stages
+        // through fixed-size buffers, so loader memory stays constant
+        // however large the export is; the tokenizer stage splits each
+        // chunk across the cores at quote-aware record boundaries. Only
+        // the title, id, winning bid and fund columns are kept.
+        LoadTimings timings;
+        bids = BidLoader::load(csvPath, arena, timings);
+        if (stages != nullptr) {
+            *stages = timings;
         }
 
-        cout << "Successfully loaded " << bids.size() << " bids." << endl;
+        cout << "Successfully loaded " << bids.size() << " bids ("
+            << arena.bytesUsed() / 1024 << " KB of text in "
+            << arena.blockCount() << " blocks)." << endl;
 
     }
     catch (const csv::Error& e) {
@@ -474,31 +608,284 @@ vector<Bid> loadBids(const string& csvPath) {
     return bids;
 }
 
+/**
+ * Saves the session as the snapshot of csvPath, reporting the outcome
+ *
+ * @param session Bids to save, in their current order
+ * @param csvPath CSV file the bids were loaded from
+ */
+void saveSnapshot(const BidSession& session, const string& csvPath) {
+    string snapshotPath = BidSnapshot::pathFor(csvPath);
+    try {
+        BidSnapshot::save(snapshotPath, session, csvPath);
+        cout << "Snapshot of " << session.size() << " bids written to " << snapshotPath;
+        if (session.isSorted() && session.size() > 1) {
+            cout << " (sorted by " << session.sortSpec().str() << ")";
+        }
+        cout << "." << endl;
+    }
+    catch (const exception& e) {
+        cerr << "Could not write snapshot: " << e.what() << endl;
+    }
+}
+
+/**
+ * Fills the session from the snapshot of csvPath, if that is still current
+ *
+ * @param session Session to fill; its previous bids are dropped on success
+ * @param csvPath CSV file the snapshot must match
+ * @return false if there is no usable snapshot
+ */
+bool loadSnapshot(BidSession& session, const string& csvPath) {
+    string snapshotPath = BidSnapshot::pathFor(csvPath);
+    if (!BidSnapshot::isFresh(snapshotPath, csvPath)) {
+        return false;
+    }
+    try {
+        BidSnapshot::load(snapshotPath, session);
+    }
+    catch (const exception& e) {
+        cerr << "Ignoring snapshot: " << e.what() << endl;
+        return false;
+    }
+    cout << "Loaded " << session.size() << " bids from snapshot " << snapshotPath;
+    if (session.isSorted() && session.size() > 1) {
+        cout << " (sorted by " << session.sortSpec().str() << ")";
+    }
+    cout << "." << endl;
+    return true;
+}
+
+/**
+ * Fills the session from the snapshot of csvPath if that is still current,
+ * otherwise parses the CSV and writes a new snapshot for next time
+ *
+ * @param session Session to fill; its previous bids are dropped
+ * @param csvPath CSV file to load
+ * @param stages Receives the time of each load stage if the CSV is parsed;
+ *        left as is if the snapshot is used
+ */
+void loadSession(BidSession& session, const string& csvPath, LoadTimings* stages = nullptr) {
+    if (loadSnapshot(session, csvPath)) {
+        return;
+    }
+
+    session.clear();
+    session.assign(loadBids(csvPath, session.arena(), stages));
+    if (!session.empty()) {
+        saveSnapshot(session, csvPath);
+    }
+}
+
+/**
+ * Prints the load time, with the busy time of each pipeline stage if the
+ * CSV was parsed. The stages overlap, so with a core each their times can
+ * add up to more than the parse took.
+ *
+ * @param loadMs Wall time of the whole load
+ * @param stages Stage times; all zero if the bids came from a snapshot
+ */
+void displayLoadTime(double loadMs, const LoadTimings& stages) {
+    cout << "Load time: " << fixed << setprecision(3) << loadMs << " ms";
+    if (stages.chunks > 0) {
+        cout << " (parse " << stages.totalMs << " ms: read " << stages.readMs
+            << ", tokenize " << stages.tokenizeMs << ", build " << stages.buildMs << " ms)";
+    }
+    cout << endl;
+}
+
+/**
+ * With instrumentation on, fills in a result's comparisons, copies and
+ * moves from a separate counted run of the algorithm (the timed run stays
+ * uncounted)
+ *
+ * @param result Result of a timed run of algorithm
+ * @param algorithm Algorithm that was timed
+ * @param bids Input of the timed run
+ * @param spec Order of the timed run
+ */
+void addOperationCounts(BenchmarkResult& result, const SortAlgorithm& algorithm, const vector<Bid>& bids,
+    const SortSpec& spec) {
+    if (!Instrumentation::enabled() || !algorithm.countOps) {
+        return;
+    }
+    OpCounts counted = algorithm.countOps(bids, spec);
+    result.ops.comparisons = counted.comparisons;
+    result.ops.copies = counted.copies;
+    result.ops.moves = counted.moves;
+}
+
+/**
+ * Every registered algorithm as a benchmark job, sorting copies of bids
+ *
+ * @param bids Input of every run; must outlive the jobs
+ * @param spec Order every algorithm sorts by; must outlive the jobs
+ */
+vector<BenchmarkJob> algorithmJobs(const vector<Bid>& bids, const SortSpec& spec) {
+    vector<BenchmarkJob> jobs;
+    for (const auto& algorithm : sortAlgorithms()) {
+        BenchmarkJob job;
+        job.name = runName(algorithm, spec);
+        job.longRunning = algorithm.quadratic;
+        job.usesPool = algorithm.parallel;
+        const SortAlgorithm* entry = &algorithm;
+        string name = job.name;
+        string complexity = runComplexity(algorithm, spec);
+        job.measure = [entry, name, complexity, &bids, &spec](const BenchmarkOptions& options) {
+            return Benchmark::measure(name, complexity, bids,
+                [entry, &spec](vector<Bid>& copy) { entry->sort(copy, spec); }, options);
+        };
+        jobs.push_back(job);
+    }
+    return jobs;
+}
+
+/**
+ * The columnar sorts as benchmark jobs, each run starting from the
+ * identity permutation of table
+ *
+ * @param table Columnar copy of the bids; must outlive the jobs
+ * @param identity table.identity(); must outlive the jobs
+ * @param spec Order the rows are sorted in; must outlive the jobs
+ */
+vector<BenchmarkJob> columnarJobs(const BidTable& table, const vector<uint32_t>& identity, const SortSpec& spec) {
+    const struct {
+        const char* name;
+        const char* complexity;
+        void (*sort)(const BidTable&, vector<uint32_t>&, const SortSpec&);
+        bool quadratic;
+    } columnar[] = {
+        { "Selection Sort (columnar)", "O(n)", &BidSorter::selectionSortTable, true },
+        { "Quick Sort (columnar)", "O(n log n)", &BidSorter::quickSortTable, false },
+        { "Merge Sort (columnar)", "O(n log n)", &BidSorter::mergeSortTable, false },
+        { "Heap Sort (columnar)", "O(n log n)", &BidSorter::heapSortTable, false },
+    };
+    vector<BenchmarkJob> jobs;
+    for (const auto& entry : columnar) {
+        BenchmarkJob job;
+        job.name = entry.name;
+        job.longRunning = entry.quadratic;
+        string name = entry.name;
+        string complexity = entry.complexity;
+        auto sort = entry.sort;
+        job.measure = [name, complexity, sort, &table, &identity, &spec](const BenchmarkOptions& options) {
+            return Benchmark::measure(name, complexity, identity,
+                [&](vector<uint32_t>& order) { sort(table, order, spec); }, options);
+        };
+        jobs.push_back(job);
+    }
+    return jobs;
+}
+
+/**
+ * Asks how to schedule a benchmark run and whether its caches start cold
+ *
+ * @param options Receives the cache setting
+ * @param sequentialLabel How option 1 is described
+ * @return The chosen mode
+ */
+BenchmarkMode chooseBenchmarkMode(BenchmarkOptions& options, const string& sequentialLabel) {
+    cout << "1. " << sequentialLabel << endl;
+    cout << "2. Concurrent: each algorithm on its own pinned core (fast, for comparisons)" << endl;
+    cout << "3. Isolated: one algorithm at a time on one pinned core (numbers to quote)" << endl;
+    int mode = getValidatedInput("Run mode (1-3): ", 1, 3);
+    cout << "1. Cache-warm: each run starts from data just copied into cache" << endl;
+    cout << "2. Cache-cold: the caches are flushed before each timed run" << endl;
+    options.coldCache = getValidatedInput("Caches (1-2): ", 1, 2) == 2;
+    return static_cast<BenchmarkMode>(mode - 1);
+}
+
+/**
+ * Prints how long a runner took against the benchmarks' own time, and the
+ * runner's notes
+ */
+void displayRunReport(const BenchmarkRunReport& report, BenchmarkMode mode, const BenchmarkOptions& options) {
+    static const char* modes[] = { "sequential", "concurrent", "isolated" };
+    cout << "Mode: " << modes[mode] << ", cache-" << (options.coldCache ? "cold" : "warm") << ", "
+        << report.threads << (report.threads == 1 ? " thread" : " threads")
+        << (report.pinned ? " pinned" : " unpinned") << endl;
+    cout << "Wall time " << fixed << setprecision(1) << report.wallMs << " ms for "
+        << report.busyMs << " ms of benchmarks";
+    if (report.wallMs > 0.0) {
+        cout << " (" << setprecision(2) << report.busyMs / report.wallMs << "x)";
+    }
+    cout << endl;
+    for (const auto& note : report.notes) {
+        cout << note << endl;
+    }
+}
+
 /**
  * Runs comprehensive benchmark comparing all sorting algorithms
  *
+ * The default mode times one run of each on this thread, with operation
+ * counts when instrumentation is on. The concurrent and isolated modes
+ * take repeated runs through BenchmarkRunner instead.
+ *
  * @param bids Vector of bids to benchmark
+ * @param spec Order every algorithm sorts by
  */
-void runBenchmarkComparison(const vector<Bid>& bids) {
+void runBenchmarkComparison(const vector<Bid>& bids, const SortSpec& spec) {
     if (bids.empty()) {
         cout << "No data available for benchmarking. Please load bids first." << endl;
         return;
     }
 
+    BenchmarkOptions runs(1, 1);
+    BenchmarkMode mode = chooseBenchmarkMode(runs, "Sequential: one run each on this thread, with counts (default)");
+    if (mode != eBENCH_SEQUENTIAL) {
+        runs.iterations = static_cast<unsigned>(getValidatedInput("Measured runs per algorithm (1-100): ", 1, 100));
+        cout << "\nBenchmarking " << bids.size() << " items by " << spec.str() << ", "
+            << runs.warmup << " warmup + " << runs.iterations << " measured runs each..." << endl;
+
+        BidTable table(bids);
+        vector<uint32_t> identity = table.identity();
+        vector<BenchmarkJob> jobs = algorithmJobs(bids, spec);
+        for (auto& job : columnarJobs(table, identity, spec)) {
+            jobs.push_back(job);
+        }
+        BenchmarkRunReport report;
+        vector<BenchmarkStats> results = BenchmarkRunner::run(jobs, mode, runs, report);
+        displayBenchmarkStats(results);
+        displayRunReport(report, mode, runs);
+        return;
+    }
+
     cout << "\nRunning comprehensive benchmark on " << bids.size() << " items..." << endl;
     vector<BenchmarkResult> results;
+    if (runs.coldCache) {
+        cout << "Caches are flushed before each run." << endl;
+    }
 
-    // Benchmark Selection Sort
-    results.push_back(benchmarkSort(&BidSorter::selectionSort, bids, "Selection Sort"));
-
-    // Benchmark Quick Sort
-    results.push_back(benchmarkSort(&BidSorter::quickSort, bids, "Quick Sort"));
+    cout << "Sort order: " << spec.str() << endl;
+    cout << "Parallel sorts: " << ThreadPool::shared().size() << " threads, cutoff "
+        << BidSorter::parallelCutoff() << " elements" << endl;
 
-    // Benchmark Merge Sort
-    results.push_back(benchmarkSort(&BidSorter::mergeSort, bids, "Merge Sort"));
+    // Benchmark every registered algorithm
+    for (const auto& algorithm : sortAlgorithms()) {
+        auto sort = [&algorithm, &spec](vector<Bid>& copy) { algorithm.sort(copy, spec); };
+        results.push_back(benchmarkSort(sort, bids, runName(algorithm, spec), runComplexity(algorithm, spec),
+            runs.coldCache));
+        addOperationCounts(results.back(), algorithm, bids, spec);
+    }
 
-    // Benchmark Heap Sort
-    results.push_back(benchmarkSort(&BidSorter::heapSort, bids, "Heap Sort"));
+    // Same algorithms over columnar storage, sorting row indices
+    BidTable table(bids);
+    results.push_back(benchmarkTableSort(&BidSorter::selectionSortTable, table, "Selection Sort (columnar)", spec,
+        runs.coldCache));
+    results.push_back(benchmarkTableSort(&BidSorter::quickSortTable, table, "Quick Sort (columnar)", spec,
+        runs.coldCache));
+    results.push_back(benchmarkTableSort(&BidSorter::mergeSortTable, table, "Merge Sort (columnar)", spec,
+        runs.coldCache));
+    results.push_back(benchmarkTableSort(&BidSorter::heapSortTable, table, "Heap Sort (columnar)", spec,
+        runs.coldCache));
+
+    // Selecting only the first ranks, to compare with the full sorts above
+    size_t k = min<size_t>(100, bids.size());
+    results.push_back(benchmarkSort([&](vector<Bid>& copy) { BidSorter::topK(copy, k, spec); },
+        bids, "Top " + to_string(k) + " (heap)", "O(n log k)", runs.coldCache));
+    results.push_back(benchmarkSort([&](vector<Bid>& copy) { BidSorter::partialQuickSort(copy, 0, k, spec); },
+        bids, "Top " + to_string(k) + " (partial quick sort)", "O(n + k log k)", runs.coldCache));
 
     displayBenchmarks(results);
 }
@@ -507,6 +894,235 @@ void runBenchmarkComparison(const vector<Bid>& bids) {
 // Main Program
 //============================================================================
 
+/**
+ * Benchmarks every algorithm over repeated runs, each on a fresh copy of
+ * the bids, and optionally exports the statistics
+ *
+ * @param bids Bids every run starts from
+ * @param spec Order every algorithm sorts by
+ */
+void runBenchmarkSuite(const vector<Bid>& bids, const SortSpec& spec) {
+    if (bids.empty()) {
+        cout << "No data available for benchmarking. Please load bids first." << endl;
+        return;
+    }
+
+    int warmup = getValidatedInput("Warmup runs per algorithm (0-100): ", 0, 100);
+    int iterations = getValidatedInput("Measured runs per algorithm (1-1000): ", 1, 1000);
+    BenchmarkOptions options(static_cast<unsigned>(warmup), static_cast<unsigned>(iterations));
+    BenchmarkMode mode = chooseBenchmarkMode(options, "Sequential: one algorithm after another on this thread");
+
+    cout << "\nBenchmarking " << bids.size() << " items by " << spec.str() << ", "
+        << options.warmup << " warmup + " << options.iterations << " measured runs each..." << endl;
+
+    // Columnar sorts start each run from the identity permutation
+    BidTable table(bids);
+    vector<uint32_t> identity = table.identity();
+    vector<BenchmarkJob> jobs = algorithmJobs(bids, spec);
+    for (auto& job : columnarJobs(table, identity, spec)) {
+        jobs.push_back(job);
+    }
+    BenchmarkRunReport report;
+    vector<BenchmarkStats> results = BenchmarkRunner::run(jobs, mode, options, report);
+
+    displayBenchmarkStats(results);
+    displayRunReport(report, mode, options);
+
+    int format = getValidatedInput("Export results (0 = no, 1 = CSV, 2 = JSON): ", 0, 2);
+    if (format == 0) {
+        return;
+    }
+    string defaultPath = (format == 1) ? "benchmark.csv" : "benchmark.json";
+    cout << "File name [" << defaultPath << "]: ";
+    string path;
+    getline(cin, path);
+    if (path.empty()) {
+        path = defaultPath;
+    }
+
+    ofstream out(path, ios::binary);
+    string label = to_string(bids.size()) + " bids by " + spec.str();
+    if (format == 1) {
+        Benchmark::writeCsv(out, results, options, label);
+    }
+    else {
+        Benchmark::writeJson(out, results, options, label);
+    }
+    if (out.flush()) {
+        cout << "Results written to " << path << "." << endl;
+    }
+    else {
+        cerr << "Could not write " << path << "." << endl;
+    }
+}
+
+/**
+ * Prints each algorithm's median time at every sweep size, and the growth
+ * exponent k (time ~ n^k) between the two largest sizes it ran at
+ *
+ * @param title Heading for the table
+ * @param spec Order the sweep sorted by
+ * @param sizes Input sizes, ascending
+ * @param medians medians[algorithm][size] in ms; negative where skipped
+ */
+void displayGrowth(const string& title, const SortSpec& spec, const vector<size_t>& sizes,
+    const vector<vector<double>>& medians) {
+    const auto& algorithms = sortAlgorithms();
+    size_t width = 30 + 12 * sizes.size() + 10;
+
+    cout << "\n" << string(width, '=') << endl;
+    cout << title << " (median ms)" << endl;
+    cout << string(width, '=') << endl;
+    cout << left << setw(30) << "Algorithm" << right;
+    for (size_t size : sizes) {
+        cout << setw(12) << size;
+    }
+    cout << setw(10) << "Growth" << endl;
+    cout << string(width, '-') << endl;
+
+    for (size_t a = 0; a < algorithms.size(); ++a) {
+        cout << left << setw(30) << runName(algorithms[a], spec) << right << fixed << setprecision(3);
+        size_t last = sizes.size();
+        size_t previous = sizes.size();
+        for (size_t s = 0; s < sizes.size(); ++s) {
+            if (medians[a][s] < 0.0) {
+                cout << setw(12) << "-";
+                continue;
+            }
+            cout << setw(12) << medians[a][s];
+            previous = last;
+            last = s;
+        }
+        if (previous < sizes.size() && medians[a][previous] > 0.0 && medians[a][last] > 0.0) {
+            double exponent = log(medians[a][last] / medians[a][previous]) /
+                log(static_cast<double>(sizes[last]) / static_cast<double>(sizes[previous]));
+            cout << setw(6) << "n^" << setprecision(2) << exponent;
+        }
+        cout << endl;
+    }
+    cout << left << string(width, '=') << endl;
+}
+
+/**
+ * Times every registered algorithm on generated bids of 10^3 up to a
+ * chosen power of ten, for one or all distributions, and prints how each
+ * algorithm's time grows. Quadratic algorithms stop at
+ * QUADRATIC_SWEEP_LIMIT items.
+ *
+ * @param spec Order every algorithm sorts by
+ */
+void runScalingSweep(const SortSpec& spec) {
+    for (int d = 0; d < BidGenerator::DISTRIBUTION_COUNT; ++d) {
+        cout << (d + 1) << ". " << BidGenerator::name(static_cast<BidDistribution>(d)) << endl;
+    }
+    cout << (BidGenerator::DISTRIBUTION_COUNT + 1) << ". all of the above" << endl;
+    int choice = getValidatedInput("Distribution (1-" + to_string(BidGenerator::DISTRIBUTION_COUNT + 1) + "): ",
+        1, BidGenerator::DISTRIBUTION_COUNT + 1);
+    int maxExponent = getValidatedInput("Largest size as a power of ten (3-7): ", 3, 7);
+    int iterations = getValidatedInput("Measured runs per size (1-20): ", 1, 20);
+    BenchmarkOptions options(1, static_cast<unsigned>(iterations));
+
+    vector<size_t> sizes;
+    for (size_t size = 1000, e = 3; e <= static_cast<size_t>(maxExponent); size *= 10, ++e) {
+        sizes.push_back(size);
+    }
+
+    const auto& algorithms = sortAlgorithms();
+    vector<pair<string, vector<BenchmarkStats>>> runs;
+    for (int d = 0; d < BidGenerator::DISTRIBUTION_COUNT; ++d) {
+        if (choice <= BidGenerator::DISTRIBUTION_COUNT && d != choice - 1) {
+            continue;
+        }
+        BidDistribution distribution = static_cast<BidDistribution>(d);
+        vector<vector<double>> medians(algorithms.size(), vector<double>(sizes.size(), -1.0));
+
+        for (size_t s = 0; s < sizes.size(); ++s) {
+            BidArena arena;
+            vector<Bid> bids = BidGenerator::generate(sizes[s], distribution, arena);
+            cout << "Sweeping " << BidGenerator::name(distribution) << ", " << sizes[s] << " bids..." << endl;
+
+            string label = string(BidGenerator::name(distribution)) + " by " + spec.str();
+            if (runs.empty() || runs.back().first != label) {
+                runs.emplace_back(label, vector<BenchmarkStats>());
+            }
+            for (size_t a = 0; a < algorithms.size(); ++a) {
+                if (algorithms[a].quadratic && sizes[s] > QUADRATIC_SWEEP_LIMIT) {
+                    continue;
+                }
+                const SortAlgorithm& algorithm = algorithms[a];
+                BenchmarkStats stats = Benchmark::measure(runName(algorithm, spec), runComplexity(algorithm, spec), bids,
+                    [&algorithm, &spec](vector<Bid>& copy) { algorithm.sort(copy, spec); }, options);
+                medians[a][s] = stats.medianMs;
+                runs.back().second.push_back(stats);
+            }
+        }
+        displayGrowth(string("Scaling sweep: ") + BidGenerator::name(distribution) + " bids by " + spec.str(), spec,
+            sizes, medians);
+    }
+
+    int format = getValidatedInput("Export results as CSV (0 = no, 1 = yes): ", 0, 1);
+    if (format == 0) {
+        return;
+    }
+    cout << "File name [sweep.csv]: ";
+    string path;
+    getline(cin, path);
+    if (path.empty()) {
+        path = "sweep.csv";
+    }
+    ofstream out(path, ios::binary);
+    for (size_t r = 0; r < runs.size(); ++r) {
+        Benchmark::writeCsv(out, runs[r].second, options, runs[r].first, r == 0);
+    }
+    if (out.flush()) {
+        cout << "Results written to " << path << "." << endl;
+    }
+    else {
+        cerr << "Could not write " << path << "." << endl;
+    }
+}
+
+/**
+ * Replaces the session's bids with a generated set, or runs a scaling
+ * sweep over generated sets
+ *
+ * @param session Session to fill with generated bids
+ * @return true if the session's bids were replaced
+ */
+bool syntheticDataMenu(BidSession& session) {
+    cout << "\n" << string(50, '-') << endl;
+    cout << "1. Replace Bids with a Generated Set" << endl;
+    cout << "2. Scaling Sweep (all algorithms, 10^3 and up)" << endl;
+    cout << "0. Back" << endl;
+    cout << string(50, '-') << endl;
+
+    int choice = getValidatedInput("Enter your choice (0-2): ", 0, 2);
+    if (choice == 2) {
+        runScalingSweep(session.sortSpec());
+    }
+    if (choice != 1) {
+        return false;
+    }
+
+    for (int d = 0; d < BidGenerator::DISTRIBUTION_COUNT; ++d) {
+        cout << (d + 1) << ". " << BidGenerator::name(static_cast<BidDistribution>(d)) << endl;
+    }
+    int distribution = getValidatedInput("Distribution (1-" + to_string(BidGenerator::DISTRIBUTION_COUNT) + "): ",
+        1, BidGenerator::DISTRIBUTION_COUNT);
+    int count = getValidatedInput("Number of bids (1-10000000): ", 1, 10000000);
+
+    auto start = steady_clock::now();
+    session.clear();
+    session.assign(BidGenerator::generate(static_cast<size_t>(count),
+        static_cast<BidDistribution>(distribution - 1), session.arena()));
+    auto end = steady_clock::now();
+
+    cout << "Generated " << session.size() << " "
+        << BidGenerator::name(static_cast<BidDistribution>(distribution - 1)) << " bids in "
+        << fixed << setprecision(3) << duration<double, milli>(end - start).count() << " ms." << endl;
+    return true;
+}
+
 /**
  * Displays the main menu options
  */
@@ -523,121 +1139,783 @@ void displayMenu() {
     cout << "7. Heap Sort (O(n log n))" << endl;
     cout << "8. Run Benchmark Comparison" << endl;
     cout << "9. Clear All Bids" << endl;
-    cout << "10. Exit" << endl;
+    cout << "10. More Sort Algorithms" << endl;
+    cout << "11. Top-K / Rank Range Query" << endl;
+    cout << "12. Search Bids" << endl;
+    cout << "13. Benchmark Suite (repeated runs, export)" << endl;
+    cout << "14. Synthetic Data and Scaling Sweep" << endl;
+    cout << "15. Exit" << endl;
     cout << string(50, '=') << endl;
 }
 
+/**
+ * Sorts the session's bids in place in the session order, timing the sort
+ *
+ * @param session Bids to sort in place
+ * @param algorithm Registered algorithm to run
+ */
+void sortBids(BidSession& session, const SortAlgorithm& algorithm) {
+    if (session.empty()) {
+        cout << "No data to sort. Please load bids first." << endl;
+        return;
+    }
+    const SortSpec& spec = session.sortSpec();
+    BenchmarkResult result(runName(algorithm, spec), session.size(), 0.0);
+
+    // The counted pass needs the unsorted bids, so it runs first
+    addOperationCounts(result, algorithm, session.bids(), spec);
+    bool sorted = session.sort([&](vector<Bid>& bids, const SortSpec& order) {
+        result.executionTimeMs = timeRun([&] { algorithm.sort(bids, order); }, result.perf, result.ops);
+    });
+    cout << result.algorithmName << " (" << spec.str() << ") completed in "
+        << result.executionTimeMs << " ms" << endl;
+    if (!sorted) {
+        cout << "Warning: the bids are not in " << spec.str() << " order afterwards." << endl;
+    }
+    if (Instrumentation::enabled()) {
+        displayCounters(result.perf, result.ops);
+    }
+}
+
+/**
+ * Lists every registered algorithm and sorts the bids with the chosen one
+ *
+ * @param session Bids to sort in place; its sort order may be changed here
+ * @param csvPath CSV file the bids came from, for saving a snapshot; empty
+ *        if they did not come from one
+ */
+void sortAlgorithmMenu(BidSession& session, const string& csvPath) {
+    const auto& algorithms = sortAlgorithms();
+    int count = static_cast<int>(algorithms.size());
+
+    cout << "\n" << string(50, '-') << endl;
+    for (int i = 0; i < count; ++i) {
+        cout << (i + 1) << ". " << algorithms[i].name
+            << " (" << algorithms[i].complexity << ")" << endl;
+    }
+    cout << (count + 1) << ". Set Parallel Cutoff (currently "
+        << BidSorter::parallelCutoff() << ")" << endl;
+    cout << (count + 2) << ". Set Sort Order (currently " << session.sortSpec().str() << ")" << endl;
+    cout << (count + 3) << ". Save Snapshot (current order)" << endl;
+    cout << (count + 4) << ". Toggle Instrumentation (currently "
+        << (Instrumentation::enabled() ? "on" : "off") << ")" << endl;
+    cout << (count + 5) << ". Export Bids to CSV (current order)" << endl;
+    cout << "0. Back" << endl;
+    cout << string(50, '-') << endl;
+
+    int choice = getValidatedInput("Enter your choice (0-" + to_string(count + 5) + "): ", 0, count + 5);
+    if (choice == 0) {
+        return;
+    }
+    if (choice == count + 1) {
+        int cutoff = getValidatedInput("Sequential cutoff in elements (2-1000000): ", 2, 1000000);
+        BidSorter::setParallelCutoff(static_cast<size_t>(cutoff));
+        cout << "Parallel cutoff set to " << BidSorter::parallelCutoff() << " elements." << endl;
+        return;
+    }
+    if (choice == count + 2) {
+        cout << "Sort order, e.g. amount:desc,fund,title (fields: id, title, fund, amount): ";
+        string text;
+        getline(cin, text);
+        try {
+            session.setSortSpec(SortSpec(text));
+            cout << "Sort order set to " << session.sortSpec().str() << "." << endl;
+        }
+        catch (const invalid_argument& e) {
+            cout << "Invalid sort order: " << e.what() << endl;
+        }
+        return;
+    }
+    if (choice == count + 3) {
+        if (session.empty() || csvPath.empty()) {
+            cout << "No bids loaded from the CSV to save. Please load bids first." << endl;
+        }
+        else {
+            saveSnapshot(session, csvPath);
+        }
+        return;
+    }
+    if (choice == count + 4) {
+        Instrumentation::setEnabled(!Instrumentation::enabled());
+        cout << "Instrumentation " << (Instrumentation::enabled() ? "on" : "off") << "." << endl;
+        if (Instrumentation::enabled()) {
+            PerfCounters probe;
+            cout << (probe.available()
+                ? "Hardware counters available."
+                : "Hardware counters unavailable here; only operation counts will be shown.") << endl;
+        }
+        return;
+    }
+    if (choice == count + 5) {
+        exportBids(session);
+        return;
+    }
+
+    sortBids(session, algorithms[choice - 1]);
+}
+
+/**
+ * Shows a range of ranks in the session order, e.g. the top 10 by amount,
+ * without sorting the bids, and times the partial selections against a
+ * full sort of the same data
+ *
+ * @param session Bids to rank; their order is left unchanged
+ */
+void rankQuery(const BidSession& session) {
+    if (session.empty()) {
+        cout << "No data to query. Please load bids first." << endl;
+        return;
+    }
+    const SortSpec& spec = session.sortSpec();
+    int total = static_cast<int>(min<size_t>(session.size(), numeric_limits<int>::max()));
+
+    int first = getValidatedInput("First rank (1-" + to_string(total) + "): ", 1, total);
+    int count = getValidatedInput("Number of bids (1-" + to_string(total - first + 1) + "): ",
+        1, total - first + 1);
+    size_t begin = static_cast<size_t>(first - 1);
+    size_t end = begin + static_cast<size_t>(count);
+
+    vector<Bid> ranked;
+    vector<BenchmarkResult> results;
+    results.push_back(benchmarkSort([&](vector<Bid>& copy) { ranked = BidSorter::topK(copy, end, spec); },
+        session.bids(), "Top-K (heap)", "O(n log k)"));
+    results.push_back(benchmarkSort([&](vector<Bid>& copy) { BidSorter::partialQuickSort(copy, begin, end, spec); },
+        session.bids(), "Partial Quick Sort", "O(n + k log k)"));
+    results.push_back(benchmarkSort([&](vector<Bid>& copy) {
+        BidSorter::withLess(spec, [&](auto less) { BidSorter::introSortBy(copy, less); });
+    }, session.bids(), "Intro Sort (full sort)"));
+    displayBenchmarks(results);
+
+    cout << "\nRanks " << first << "-" << (first + count - 1) << " by " << spec.str() << ":" << endl;
+    cout << string(60, '-') << endl;
+    BidWriter writer(cout);
+    for (size_t i = begin; i < end; ++i) {
+        writer.number(i + 1);
+        writer.text(". ");
+        writer.write(ranked[i]);
+    }
+}
+
+/**
+ * Looks bids up by id, fund or amount range through the session indexes
+ * instead of scanning every bid
+ *
+ * @param session Bids to search
+ */
+void searchMenu(const BidSession& session) {
+    if (session.empty()) {
+        cout << "No bids to search. Please load data first." << endl;
+        return;
+    }
+    const BidIndex& index = session.index();
+
+    cout << "\n" << string(50, '-') << endl;
+    cout << "1. Find by Bid Id" << endl;
+    cout << "2. Find by Fund" << endl;
+    cout << "3. Find by Amount Range" << endl;
+    cout << "0. Back" << endl;
+    cout << string(50, '-') << endl;
+
+    int choice = getValidatedInput("Enter your choice (0-3): ", 0, 3);
+    if (choice == 0) {
+        return;
+    }
+
+    string key;
+    double low = 0.0;
+    double high = 0.0;
+    if (choice == 1) {
+        cout << "Enter Id: ";
+        getline(cin, key);
+    }
+    else if (choice == 2) {
+        for (const auto& fund : index.funds()) {
+            cout << "  " << (fund.first.empty() ? string_view("(blank)") : fund.first)
+                << " (" << fund.second << " bids)" << endl;
+        }
+        cout << "Enter fund: ";
+        getline(cin, key);
+    }
+    else {
+        cout << "Lowest amount: ";
+        getline(cin, key);
+        low = strToDouble(key);
+        cout << "Highest amount: ";
+        getline(cin, key);
+        high = strToDouble(key);
+    }
+
+    auto start = high_resolution_clock::now();
+    vector<Bid> found = (choice == 1) ? index.findById(key)
+        : (choice == 2) ? index.findByFund(key)
+        : index.findByAmount(low, high);
+    auto end = high_resolution_clock::now();
+    auto duration = duration_cast<microseconds>(end - start);
+
+    cout << "\nFound " << found.size() << " bids in " << fixed << setprecision(3)
+        << duration.count() / 1000.0 << " ms:" << endl;
+    cout << string(60, '-') << endl;
+    BidWriter writer(cout);
+    writer.write(found);
+}
+
+//============================================================================
+// Batch Mode
+//============================================================================
+
+/**
+ * Settings of a non-interactive run, from the command line
+ */
+struct BatchOptions {
+    string input = "eBid_Monthly_Sales.csv";
+    string sort;                // registry entry to sort with, by commandName(); empty: keep file order
+    string key;                 // SortSpec text; empty: title
+    string output;              // "-" for stdout; empty: stdout unless benchmarking
+    BidFormat format = eDISPLAY;
+    size_t limit = static_cast<size_t>(-1);     // most bids to write
+    unsigned benchIterations = 0;   // 0: no benchmark
+    string benchOutput;         // CSV, or JSON if it ends in .json; empty: table only
+    BenchmarkMode benchMode = eBENCH_SEQUENTIAL;
+    bool coldCache = false;     // flush the caches before every timed benchmark run
+    bool snapshot = true;       // use and refresh the snapshot beside the CSV
+    bool counters = false;      // report instrumentation counts for the load and the sort
+    size_t externalMiB = 0;     // run size of an external sort; 0: sort in memory
+    string tempDir;             // where external runs are spilled; empty: the system's
+};
+
+/**
+ * @return The name an algorithm is chosen by on the command line: its
+ *         registry name in lower case, without "Sort", with every other
+ *         run of punctuation or spaces turned into a dash, e.g.
+ *         "merge-buffered" for "Merge Sort (buffered)"
+ */
+string commandName(const SortAlgorithm& algorithm) {
+    string name;
+    string word;
+    auto addWord = [&name, &word]() {
+        if (!word.empty() && word != "sort") {
+            name += (name.empty() ? "" : "-") + word;
+        }
+        word.clear();
+    };
+    for (char c : algorithm.name) {
+        if (isalnum(static_cast<unsigned char>(c))) {
+            word += static_cast<char>(tolower(static_cast<unsigned char>(c)));
+        }
+        else {
+            addWord();
+        }
+    }
+    addWord();
+    return name;
+}
+
+/**
+ * @return The registered algorithm whose commandName() is name, or nullptr
+ */
+const SortAlgorithm* findAlgorithm(const string& name) {
+    for (const auto& algorithm : sortAlgorithms()) {
+        if (commandName(algorithm) == name) {
+            return &algorithm;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * Prints command-line usage and every algorithm name --sort accepts
+ *
+ * @param out Stream to print to
+ * @param program Name the program was started as
+ */
+void printUsage(ostream& out, const string& program) {
+    out << "Usage: " << program << " [csv-file]                 (interactive menu)\n"
+        << "       " << program << " --input=FILE [options]     (batch mode)\n"
+        << "\n"
+        << "Batch options:\n"
+        << "  --input=FILE        CSV file to load (default eBid_Monthly_Sales.csv)\n"
+        << "  --sort=NAME         sort with NAME; without it bids keep their file order\n"
+        << "  --key=ORDER         sort order, e.g. amount:desc,title (default title)\n"
+        << "  --output=FILE       write the bids to FILE, or - for stdout (the default,\n"
+        << "                      except with --bench, which writes them only if asked)\n"
+        << "  --format=FORMAT     display (default) or csv, which loads back as --input\n"
+        << "  --limit=N           write only the first N bids\n"
+        << "  --bench[=N]         time N runs (default 10) of --sort, or of every algorithm\n"
+        << "  --bench-output=FILE export the benchmark as CSV, or JSON for a .json FILE\n"
+        << "  --bench-mode=MODE   sequential (default); concurrent, each algorithm pinned to\n"
+        << "                      its own core; or isolated, one at a time on one pinned core\n"
+        << "  --cold-cache        flush the caches before every timed benchmark run\n"
+        << "  --no-snapshot       always parse the CSV; neither read nor write its snapshot\n"
+        << "  --counters          report hardware, copy and allocation counts of the load and sort\n"
+        << "  --external[=MB]     sort with --sort in runs of MB MiB (default 64) spilled to disk,\n"
+        << "                      then merge them, for files larger than memory\n"
+        << "  --temp-dir=DIR      where --external spills its runs (default the system's)\n"
+        << "  --help              show this message\n"
+        << "\n"
+        << "Progress and timings go to stderr, so stdout carries only the bids.\n"
+        << "\n"
+        << "Sort names:\n";
+    for (const auto& algorithm : sortAlgorithms()) {
+        out << "  " << left << setw(22) << commandName(algorithm) << algorithm.name
+            << " (" << algorithm.complexity << ")\n";
+    }
+    out.flush();
+}
+
+/**
+ * Reads batch options from the command line, accepting both --name=value
+ * and --name value
+ *
+ * @return Parsed options
+ * @throws std::invalid_argument on an unknown option, a missing or bad
+ *         value, or an unknown sort name
+ */
+BatchOptions parseBatchOptions(int argc, char* argv[]) {
+    BatchOptions options;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        string name = arg;
+        string value;
+        bool hasValue = false;
+        size_t equals = arg.find('=');
+        if (equals != string::npos) {
+            name = arg.substr(0, equals);
+            value = arg.substr(equals + 1);
+            hasValue = true;
+        }
+        auto requireValue = [&]() {
+            if (!hasValue) {
+                if (i + 1 >= argc) {
+                    throw invalid_argument(name + " needs a value");
+                }
+                value = argv[++i];
+            }
+            return value;
+        };
+
+        if (name == "--input") {
+            options.input = requireValue();
+        }
+        else if (name == "--sort") {
+            options.sort = requireValue();
+            if (!findAlgorithm(options.sort)) {
+                throw invalid_argument("unknown sort '" + options.sort + "'");
+            }
+        }
+        else if (name == "--key") {
+            options.key = requireValue();
+            SortSpec check(options.key);    // throws on a bad order
+        }
+        else if (name == "--output") {
+            options.output = requireValue();
+        }
+        else if (name == "--format") {
+            string format = requireValue();
+            if (format == "display") options.format = eDISPLAY;
+            else if (format == "csv") options.format = eCSV;
+            else throw invalid_argument("unknown format '" + format + "'");
+        }
+        else if (name == "--limit") {
+            string limit = requireValue();
+            char* end = nullptr;
+            unsigned long long count = strtoull(limit.c_str(), &end, 10);
+            if (limit.empty() || limit[0] == '-' || *end != '\0') {
+                throw invalid_argument("--limit needs a bid count");
+            }
+            options.limit = static_cast<size_t>(count);
+        }
+        else if (name == "--bench") {
+            options.benchIterations = 10;
+            if (hasValue) {
+                char* end = nullptr;
+                unsigned long count = strtoul(value.c_str(), &end, 10);
+                if (value.empty() || *end != '\0' || count < 1 || count > 100000) {
+                    throw invalid_argument("--bench needs a run count from 1 to 100000");
+                }
+                options.benchIterations = static_cast<unsigned>(count);
+            }
+        }
+        else if (name == "--bench-output") {
+            options.benchOutput = requireValue();
+        }
+        else if (name == "--bench-mode") {
+            string mode = requireValue();
+            if (mode == "sequential") options.benchMode = eBENCH_SEQUENTIAL;
+            else if (mode == "concurrent") options.benchMode = eBENCH_CONCURRENT;
+            else if (mode == "isolated") options.benchMode = eBENCH_ISOLATED;
+            else throw invalid_argument("unknown benchmark mode '" + mode + "'");
+        }
+        else if (name == "--cold-cache" && !hasValue) {
+            options.coldCache = true;
+        }
+        else if (name == "--no-snapshot" && !hasValue) {
+            options.snapshot = false;
+        }
+        else if (name == "--counters" && !hasValue) {
+            options.counters = true;
+        }
+        else if (name == "--external") {
+            options.externalMiB = 64;
+            if (hasValue) {
+                char* end = nullptr;
+                unsigned long size = strtoul(value.c_str(), &end, 10);
+                if (value.empty() || *end != '\0' || size < 1 || size > 1048576) {
+                    throw invalid_argument("--external needs a run size in MiB from 1 to 1048576");
+                }
+                options.externalMiB = static_cast<size_t>(size);
+            }
+        }
+        else if (name == "--temp-dir") {
+            options.tempDir = requireValue();
+        }
+        else {
+            throw invalid_argument("unknown option '" + arg + "'");
+        }
+    }
+    if (!options.key.empty() && options.sort.empty() && options.benchIterations == 0) {
+        throw invalid_argument("--key needs --sort or --bench");
+    }
+    if ((options.benchMode != eBENCH_SEQUENTIAL || options.coldCache) && options.benchIterations == 0) {
+        throw invalid_argument("--bench-mode and --cold-cache need --bench");
+    }
+    if (options.externalMiB > 0 && options.sort.empty()) {
+        throw invalid_argument("--external needs --sort");
+    }
+    if (options.externalMiB > 0 && options.benchIterations > 0) {
+        throw invalid_argument("--external cannot be combined with --bench");
+    }
+    return options;
+}
+
+/**
+ * Repeatedly times the chosen algorithm, or every registered one, on the
+ * session's bids and prints (and optionally exports) the statistics
+ *
+ * @param session Bids every run starts from
+ * @param options Batch settings
+ * @return false if the export could not be written
+ */
+bool runBatchBenchmark(const BidSession& session, const BatchOptions& options) {
+    const SortSpec& spec = session.sortSpec();
+    BenchmarkOptions runs(1, options.benchIterations, options.coldCache);
+    vector<BenchmarkJob> jobs = algorithmJobs(session.bids(), spec);
+    if (!options.sort.empty()) {
+        const string name = runName(*findAlgorithm(options.sort), spec);
+        jobs.erase(remove_if(jobs.begin(), jobs.end(), [&name](const BenchmarkJob& job) { return job.name != name; }),
+            jobs.end());
+    }
+    cout << "Benchmarking " << jobs.size() << (jobs.size() == 1 ? " algorithm" : " algorithms") << ", "
+        << runs.warmup << " warmup + " << runs.iterations << " measured runs each..." << endl;
+    cout << "Build: " << ENHANCED_SORTING_BUILD_INFO << endl;
+    BenchmarkRunReport report;
+    vector<BenchmarkStats> results = BenchmarkRunner::run(jobs, options.benchMode, runs, report);
+    displayBenchmarkStats(results);
+    displayRunReport(report, options.benchMode, runs);
+
+    if (options.benchOutput.empty()) {
+        return true;
+    }
+    ofstream out(options.benchOutput, ios::binary);
+    string label = to_string(session.size()) + " bids by " + spec.str() + ", " + ENHANCED_SORTING_BUILD_INFO;
+    const string json = ".json";
+    const string& path = options.benchOutput;
+    if (path.size() >= json.size() && path.compare(path.size() - json.size(), json.size(), json) == 0) {
+        Benchmark::writeJson(out, results, runs, label);
+    }
+    else {
+        Benchmark::writeCsv(out, results, runs, label);
+    }
+    if (!out.flush()) {
+        cerr << "Could not write " << path << "." << endl;
+        return false;
+    }
+    cout << "Benchmark written to " << path << "." << endl;
+    return true;
+}
+
+/**
+ * Sorts options.input without holding it in memory: runs of the budget are
+ * sorted with --sort, spilled, and merged straight into the output
+ *
+ * @param options Batch settings, with externalMiB and sort set
+ * @param bidStream Stream standing for stdout
+ * @return Process exit status: 0 on success, 1 if a step failed
+ */
+int runExternalSort(const BatchOptions& options, ostream& bidStream) {
+    const SortAlgorithm& algorithm = *findAlgorithm(options.sort);
+    SortSpec spec = options.key.empty() ? SortSpec() : SortSpec(options.key);
+    ExternalSorter sorter(options.externalMiB << 20, algorithm.sort, options.tempDir);
+
+    ofstream file;
+    bool toStdout = options.output.empty() || options.output == "-";
+    string target = toStdout ? string("stdout") : options.output;
+    if (!toStdout) {
+        file.open(options.output, ios::binary | ios::trunc);
+    }
+    // A writer thread takes the output, so the merge never waits on it
+    WriteBehindBuffer behind(toStdout ? bidStream.rdbuf() : file.rdbuf());
+    ostream out(&behind);
+    BidWriter writer(out, options.format, 1 << 20);
+    writer.writeHeader();
+
+    Instrumentation::setEnabled(options.counters);
+    PerfSample perf;
+    OpCounts ops;
+    ExternalSortStats stats;
+    double totalMs = 0.0;
+    try {
+        totalMs = timeRun([&] {
+            stats = sorter.sort(options.input, spec, [&](const Bid& bid) {
+                if (writer.rows() < options.limit) {
+                    writer.write(bid);
+                }
+            });
+        }, perf, ops);
+    }
+    catch (const csv::Error& e) {
+        cerr << "CSV Error: " << e.what() << endl;
+        return 1;
+    }
+    catch (const exception& e) {
+        cerr << "External sort failed: " << e.what() << endl;
+        return 1;
+    }
+    if (!writer.flush() || !behind.close()) {
+        cerr << "Could not write " << target << "." << endl;
+        return 1;
+    }
+
+    cout << runName(algorithm, spec) << " (" << spec.str() << ") external sort of " << stats.rows
+        << " bids completed in " << fixed << setprecision(3) << totalMs << " ms" << endl;
+    if (stats.runs == 0) {
+        cout << "  Input fit in " << options.externalMiB << " MiB; sorted in memory without spilling" << endl;
+    }
+    else {
+        cout << "  Runs:   " << stats.runs << " of up to " << options.externalMiB << " MiB, "
+            << setprecision(1) << stats.spilledBytes / 1048576.0 << " MiB spilled, "
+            << stats.mergePasses << " intermediate merge passes" << endl;
+    }
+    cout << "  Phases: " << setprecision(3) << stats.runMs << " ms to read, sort and spill ("
+        << stats.sortMs << " ms sorting), " << stats.mergeMs << " ms to merge and write" << endl;
+    if (options.counters) {
+        displayCounters(perf, ops);
+    }
+    cout << "Wrote " << writer.rows() << " bids to " << target << "." << endl;
+    return 0;
+}
+
+/**
+ * Runs load, sort, benchmark and write without prompting
+ *
+ * Everything the interactive code prints goes to stderr while this runs,
+ * so stdout carries nothing but the bids. Bids go through a 1 MiB
+ * BidWriter buffer with no per-line flush.
+ *
+ * @return Process exit status: 0 on success, 1 if a step failed, 2 on a
+ *         usage error
+ */
+int runBatch(int argc, char* argv[]) {
+    BatchOptions options;
+    try {
+        options = parseBatchOptions(argc, argv);
+    }
+    catch (const invalid_argument& e) {
+        cerr << "Error: " << e.what() << " (see " << argv[0] << " --help)" << endl;
+        return 2;
+    }
+
+    ios::sync_with_stdio(false);
+    ostream bidStream(cout.rdbuf());
+    cout.rdbuf(cerr.rdbuf());
+    struct RestoreCout {
+        streambuf* buffer;
+        ~RestoreCout() { cout.rdbuf(buffer); }
+    } restore{ bidStream.rdbuf() };
+
+    if (options.externalMiB > 0) {
+        return runExternalSort(options, bidStream);
+    }
+
+    BidSession session;
+    Instrumentation::setEnabled(options.counters);
+    PerfSample perf;
+    OpCounts ops;
+    LoadTimings stages;
+    double loadMs = timeRun([&] {
+        if (options.snapshot) {
+            loadSession(session, options.input, &stages);
+        }
+        else {
+            session.assign(loadBids(options.input, session.arena(), &stages));
+        }
+    }, perf, ops);
+    if (session.empty()) {
+        cerr << "No bids loaded from " << options.input << "." << endl;
+        return 1;
+    }
+    displayLoadTime(loadMs, stages);
+    if (options.counters) {
+        displayCounters(perf, ops);
+    }
+
+    // A snapshot may come back sorted in another order; the requested one wins
+    session.setSortSpec(options.key.empty() ? SortSpec() : SortSpec(options.key));
+
+    if (options.benchIterations > 0 && !runBatchBenchmark(session, options)) {
+        return 1;
+    }
+
+    if (!options.sort.empty()) {
+        const SortAlgorithm& algorithm = *findAlgorithm(options.sort);
+        BenchmarkResult result(runName(algorithm, session.sortSpec()), session.size(), 0.0);
+        addOperationCounts(result, algorithm, session.bids(), session.sortSpec());
+        bool sorted = session.sort([&](vector<Bid>& bids, const SortSpec& order) {
+            result.executionTimeMs = timeRun([&] { algorithm.sort(bids, order); }, result.perf, result.ops);
+        });
+        cout << result.algorithmName << " (" << session.sortSpec().str() << ") completed in "
+            << fixed << setprecision(3) << result.executionTimeMs << " ms" << endl;
+        if (!sorted) {
+            cerr << "Warning: the bids are not in " << session.sortSpec().str() << " order afterwards." << endl;
+        }
+        if (options.counters) {
+            displayCounters(result.perf, result.ops);
+        }
+    }
+
+    if (options.output.empty() && options.benchIterations > 0) {
+        return 0;
+    }
+
+    auto start = steady_clock::now();
+    ofstream file;
+    bool toStdout = options.output.empty() || options.output == "-";
+    if (!toStdout) {
+        file.open(options.output, ios::binary | ios::trunc);
+    }
+    BidWriter writer(toStdout ? bidStream : file, options.format, 1 << 20);
+    writer.writeHeader();
+    writer.write(session.bids(), 0, options.limit);
+    if (!writer.flush()) {
+        cerr << "Could not write " << (toStdout ? string("stdout") : options.output) << "." << endl;
+        return 1;
+    }
+    auto end = steady_clock::now();
+    cout << "Wrote " << writer.rows() << " bids to " << (toStdout ? string("stdout") : options.output)
+        << " in " << fixed << setprecision(3) << duration<double, milli>(end - start).count() << " ms" << endl;
+    return 0;
+}
+
 /**
  * Main function - Program entry point
  */
 int main(int argc, char* argv[]) {
-    // Process command line arguments
+    // Any --option selects batch mode; otherwise the only argument is the CSV
+    for (int i = 1; i < argc; ++i) {
+        if (string(argv[i]) == "--help" || string(argv[i]) == "-h") {
+            printUsage(cout, argv[0]);
+            return 0;
+        }
+        if (string(argv[i]).compare(0, 2, "--") == 0) {
+            return runBatch(argc, argv);
+        }
+    }
+    if (argc > 2) {
+        printUsage(cerr, argv[0]);
+        return 2;
+    }
     string csvPath = (argc == 2) ? argv[1] : "eBid_Monthly_Sales.csv";
 
-    vector<Bid> bids;
+    BidSession session;   // bids, their text and the order they are kept in
 
     cout << "Enhanced Vector Sorting System v2.0" << endl;
     cout << "Default CSV file: " << csvPath << endl;
 
+    // A snapshot newer than the CSV loads without parsing, so use it at once
+    string loadedFrom;    // CSV the session's bids came from, if any
+    if (loadSnapshot(session, csvPath)) {
+        loadedFrom = csvPath;
+    }
+
     int choice = 0;
-    while (choice != 10) {
+    while (choice != 15) {
         displayMenu();
-        choice = getValidatedInput("Enter your choice (1-10): ", 1, 10);
+        choice = getValidatedInput("Enter your choice (1-15): ", 1, 15);
 
         switch (choice) {
         case 1: {
-            auto start = high_resolution_clock::now();
-            bids = loadBids(csvPath);
-            auto end = high_resolution_clock::now();
-            auto duration = duration_cast<milliseconds>(end - start);
-            cout << "Load time: " << duration.count() << " ms" << endl;
+            PerfSample perf;
+            OpCounts ops;
+            LoadTimings stages;
+            double loadMs = timeRun([&] { loadSession(session, csvPath, &stages); }, perf, ops);
+            loadedFrom = csvPath;
+            displayLoadTime(loadMs, stages);
+            if (Instrumentation::enabled()) {
+                displayCounters(perf, ops);
+            }
             break;
         }
 
         case 2:
-            if (bids.empty()) {
-                cout << "No bids to display. Please load data first." << endl;
-            }
-            else {
-                cout << "\nDisplaying " << bids.size() << " bids:" << endl;
-                cout << string(60, '-') << endl;
-                for (const auto& bid : bids) {
-                    displayBid(bid);
-                }
-            }
+            displayBids(session);
             break;
 
         case 3: {
-            Bid newBid = getBid();
-            bids.push_back(newBid);
-            cout << "Bid added successfully. Total bids: " << bids.size() << endl;
+            Bid newBid = getBid(session.arena());
+            bool keptSorted = session.isSorted();
+            size_t position = session.insert(newBid);
+            cout << "Bid added successfully. Total bids: " << session.size() << endl;
+            if (keptSorted) {
+                cout << "Inserted at position " << (position + 1) << " (still sorted by "
+                    << session.sortSpec().str() << ")." << endl;
+            }
             break;
         }
 
-        case 4: {
-            if (bids.empty()) {
-                cout << "No data to sort. Please load bids first." << endl;
-                break;
-            }
-            auto result = benchmarkSort(&BidSorter::selectionSort, bids, "Selection Sort");
-            bids = loadBids(csvPath);  // Reload for sorting
-            BidSorter::selectionSort(bids);
-            cout << "Selection Sort completed in " << result.executionTimeMs << " ms" << endl;
+        case 4:
+        case 5:
+        case 6:
+        case 7:
+            sortBids(session, sortAlgorithms()[choice - 4]);
             break;
-        }
 
-        case 5: {
-            if (bids.empty()) {
-                cout << "No data to sort. Please load bids first." << endl;
-                break;
-            }
-            auto result = benchmarkSort(&BidSorter::quickSort, bids, "Quick Sort");
-            if (bids.size() > 0) {
-                BidSorter::quickSort(bids, 0, bids.size() - 1);
-            }
-            cout << "Quick Sort completed in " << result.executionTimeMs << " ms" << endl;
+        case 8:
+            runBenchmarkComparison(session.bids(), session.sortSpec());
             break;
-        }
 
-        case 6: {
-            if (bids.empty()) {
-                cout << "No data to sort. Please load bids first." << endl;
-                break;
-            }
-            auto result = benchmarkSort(&BidSorter::mergeSort, bids, "Merge Sort");
-            if (bids.size() > 0) {
-                BidSorter::mergeSort(bids, 0, bids.size() - 1);
-            }
-            cout << "Merge Sort completed in " << result.executionTimeMs << " ms" << endl;
+        case 9:
+            session.clear();
+            loadedFrom.clear();
+            cout << "All bids cleared from memory." << endl;
             break;
-        }
 
-        case 7: {
-            if (bids.empty()) {
-                cout << "No data to sort. Please load bids first." << endl;
-                break;
-            }
-            auto result = benchmarkSort(&BidSorter::heapSort, bids, "Heap Sort");
-            BidSorter::heapSort(bids);
-            cout << "Heap Sort completed in " << result.executionTimeMs << " ms" << endl;
+        case 10:
+            sortAlgorithmMenu(session, loadedFrom);
             break;
-        }
 
-        case 8:
-            runBenchmarkComparison(bids);
+        case 11:
+            rankQuery(session);
             break;
 
-        case 9:
-            bids.clear();
-            cout << "All bids cleared from memory." << endl;
+        case 12:
+            searchMenu(session);
             break;
 
-        case 10:
+        case 13:
+            runBenchmarkSuite(session.bids(), session.sortSpec());
+            break;
+
+        case 14:
+            if (syntheticDataMenu(session)) {
+                loadedFrom.clear();
+            }
+            break;
+
+        case 15:
             cout << "Thank you for using Enhanced Vector Sorting System!" << endl;
             break;
         }
 
-        if (choice != 10) {
+        if (choice != 15) {
             cout << "\nPress Enter to continue...";
             cin.ignore();
             cin.get();
@@ -0,0 +1,822 @@
+//============================================================================
+// Name        : ExternalSort.hpp
+// Description : Sort of CSV exports larger than memory: sorted runs spilled to disk, then k-way merged
+//============================================================================
+
+#ifndef _EXTERNALSORT_HPP_
+#define _EXTERNALSORT_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Bid.hpp"
+#include "BidLoader.hpp"
+#include "BidSorter.hpp"
+#include "CSVparser.hpp"
+#include "SortSpec.hpp"
+#include "SpscQueue.hpp"
+
+/**
+ * Where the time of an external sort went
+ */
+struct ExternalSortStats {
+    size_t rows = 0;
+    size_t runs = 0;            // sorted runs spilled from the input; 0 if it fit the budget
+    size_t mergePasses = 0;     // intermediate passes, needed only past the fan-in
+    size_t spilledBytes = 0;    // written to run files over all passes
+    double runMs = 0.0;         // input parse, run sorts and spills
+    double sortMs = 0.0;        // the run sorts alone
+    double mergeMs = 0.0;       // every merge pass, the final one included
+    double totalMs = 0.0;
+};
+
+/**
+ * Output stream buffer that hands each full buffer to a writer thread, so
+ * the thread producing the bytes only waits on the target when it gets
+ * more than depth buffers ahead of it
+ *
+ * pubsync() (an ostream flush) waits until every queued buffer has reached
+ * the target, then flushes the target. After a write to the target fails
+ * later buffers are dropped and sync() fails, so a stream on top goes bad
+ * at its next flush.
+ */
+class WriteBehindBuffer : public std::streambuf {
+public:
+    /**
+     * @param target Where the bytes end up; must outlive this buffer
+     * @param bufferSize Bytes per buffer
+     * @param depth Full buffers that may wait for the writer
+     */
+    explicit WriteBehindBuffer(std::streambuf* target, size_t bufferSize = 1 << 20, size_t depth = 2)
+        : target(target), freeBuffers(depth + 1), fullBuffers(depth + 1), current(nullptr),
+          queued(0), written(0), failed(false), closed(false) {
+        for (size_t i = 0; i <= depth; ++i) {
+            buffers.emplace_back(new Buffer());
+            buffers.back()->data.resize(std::max<size_t>(bufferSize, 4096));
+            freeBuffers.tryPush(buffers.back().get());
+        }
+        freeBuffers.tryPop(current);
+        reset();
+        writer = std::thread([this]() { drain(); });
+    }
+
+    ~WriteBehindBuffer() { close(); }
+
+    WriteBehindBuffer(const WriteBehindBuffer&) = delete;
+    WriteBehindBuffer& operator=(const WriteBehindBuffer&) = delete;
+
+    /**
+     * Writes out everything buffered and stops the writer thread; later
+     * output is refused
+     *
+     * @return false if any write to the target failed
+     */
+    bool close() {
+        if (!closed) {
+            sync();
+            closed = true;
+            fullBuffers.close();
+            writer.join();
+        }
+        return !failed.load(std::memory_order_acquire);
+    }
+
+protected:
+    int_type overflow(int_type c) override {
+        if (closed || !handOff()) {
+            return traits_type::eof();
+        }
+        if (!traits_type::eq_int_type(c, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+        }
+        return traits_type::not_eof(c);
+    }
+
+    int sync() override {
+        if (closed || !handOff()) {
+            return -1;
+        }
+        {
+            std::unique_lock<std::mutex> lock(progressLock);
+            progress.wait(lock, [this]() { return written == queued; });
+        }
+        if (failed.load(std::memory_order_acquire)) {
+            return -1;
+        }
+        return target->pubsync();
+    }
+
+private:
+    struct Buffer {
+        std::vector<char> data;
+        size_t size = 0;
+    };
+
+    void reset() {
+        setp(current->data.data(), current->data.data() + current->data.size());
+    }
+
+    /**
+     * Queues the buffer being filled, if it holds anything, and takes a
+     * free one, waiting for the writer if there is none
+     */
+    bool handOff() {
+        current->size = static_cast<size_t>(pptr() - pbase());
+        if (current->size > 0) {
+            if (!fullBuffers.push(current)) {
+                return false;
+            }
+            ++queued;
+            if (!freeBuffers.pop(current)) {
+                return false;
+            }
+        }
+        reset();
+        return !failed.load(std::memory_order_acquire);
+    }
+
+    /**
+     * Writer thread: moves full buffers to the target and returns them
+     */
+    void drain() {
+        Buffer* buffer;
+        while (fullBuffers.pop(buffer)) {
+            if (!failed.load(std::memory_order_relaxed)) {
+                std::streamsize size = static_cast<std::streamsize>(buffer->size);
+                bool ok = false;
+                try {
+                    ok = target->sputn(buffer->data.data(), size) == size;
+                }
+                catch (...) {
+                }
+                if (!ok) {
+                    failed.store(true, std::memory_order_release);
+                }
+            }
+            {
+                std::lock_guard<std::mutex> lock(progressLock);
+                ++written;
+            }
+            progress.notify_one();
+            freeBuffers.push(buffer);
+        }
+    }
+
+    std::streambuf* target;
+    std::vector<std::unique_ptr<Buffer>> buffers;
+    SpscQueue<Buffer*> freeBuffers;     // writer thread to producer
+    SpscQueue<Buffer*> fullBuffers;     // producer to writer thread
+    Buffer* current;                    // being filled; owned by the producer
+    size_t queued;                      // buffers handed off; producer only
+    size_t written;                     // buffers the writer is done with; under progressLock
+    std::mutex progressLock;
+    std::condition_variable progress;   // written went up
+    std::atomic<bool> failed;
+    bool closed;
+    std::thread writer;
+};
+
+/**
+ * Sorts a CSV export that need not fit in memory
+ *
+ * The input streams through BidLoader's pipeline into a run held to the
+ * memory budget. Each full run is sorted with the in-memory sort the
+ * sorter was given and spilled to a temporary file, through a
+ * WriteBehindBuffer so the next run fills while the last one is written.
+ * The runs are then merged with a loser tree: k sorted inputs cost
+ * ceil(log2 k) comparisons per bid, each against the one stored loser on
+ * the winner's path to the root. One read-ahead thread keeps a block of
+ * every run in flight behind the one being merged. More runs than the
+ * fan-in are first merged in groups into longer runs.
+ *
+ * Ties go to the earlier run, so with a stable run sort the output is
+ * exactly what a stable in-memory sort of the whole file would give.
+ * Input that fits the budget is sorted in memory without touching disk.
+ *
+ * Run file record, in host byte order (run files live only as long as the
+ * sort):
+ *
+ *   varint       id, title and fund lengths, 7 bits per byte, low first
+ *   double       amount
+ *   char[]       id, title and fund text
+ */
+class ExternalSorter {
+public:
+    typedef std::function<void(std::vector<Bid>&, const SortSpec&)> RunSort;
+
+    /**
+     * @param memoryBudget Bytes of bids and text one run may hold; the
+     *        merge's read-ahead blocks share the same budget
+     * @param sortRun In-memory sort for each run, e.g. a registry entry's
+     * @param tempDirectory Where run files go; empty for the system's
+     *        temporary directory
+     * @param fanIn Most runs one merge pass reads at once
+     */
+    ExternalSorter(size_t memoryBudget, RunSort sortRun, std::string tempDirectory = std::string(),
+                   size_t fanIn = 64)
+        : memoryBudget(std::max<size_t>(memoryBudget, 1 << 16)), sortRun(std::move(sortRun)),
+          tempDirectory(std::move(tempDirectory)), fanIn(std::max<size_t>(fanIn, 2)) {
+    }
+
+    /**
+     * Sorts the bids of csvPath and hands them to output(const Bid&) in
+     * order; each bid's text is valid only during the call
+     *
+     * @return Where the time went
+     * @throws csv::Error if the CSV cannot be opened or is malformed
+     * @throws std::runtime_error if a run file cannot be written or read
+     */
+    template<typename Output>
+    ExternalSortStats sort(const std::string& csvPath, const SortSpec& order, Output&& output) {
+        return BidSorter::withLess(order, [&](auto less) { return sortBy(csvPath, order, less, output); });
+    }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    size_t memoryBudget;
+    RunSort sortRun;
+    std::string tempDirectory;
+    size_t fanIn;
+
+    static double elapsedMs(Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    /**
+     * Private directory for the run files of one sort, removed with them
+     */
+    class RunDirectory {
+    public:
+        explicit RunDirectory(const std::string& parent) : next(0) {
+            std::filesystem::path root = parent.empty() ? std::filesystem::temp_directory_path()
+                                                        : std::filesystem::path(parent);
+            std::random_device random;
+            for (int attempt = 0; attempt < 16 && directory.empty(); ++attempt) {
+                std::filesystem::path candidate = root / ("bidsort-" + std::to_string(random()));
+                std::error_code error;
+                if (std::filesystem::create_directory(candidate, error)) {
+                    directory = candidate;
+                }
+                else if (error) {
+                    throw std::runtime_error("cannot create a run directory in " + root.string() + ": "
+                                             + error.message());
+                }
+            }
+            if (directory.empty()) {
+                throw std::runtime_error("cannot create a run directory in " + root.string());
+            }
+        }
+
+        ~RunDirectory() {
+            std::error_code ignored;
+            std::filesystem::remove_all(directory, ignored);
+        }
+
+        RunDirectory(const RunDirectory&) = delete;
+        RunDirectory& operator=(const RunDirectory&) = delete;
+
+        std::string newRun() {
+            return (directory / ("run-" + std::to_string(next++) + ".bin")).string();
+        }
+
+    private:
+        std::filesystem::path directory;
+        size_t next;
+    };
+
+    /**
+     * A run being written; the file is unbuffered, WriteBehindBuffer
+     * hands it whole buffers
+     */
+    class RunWriter {
+    public:
+        explicit RunWriter(std::string runPath) : path(std::move(runPath)), bytes(0) {
+            file.rdbuf()->pubsetbuf(nullptr, 0);
+            file.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) {
+                throw std::runtime_error("cannot create run file " + path);
+            }
+            buffer.reset(new WriteBehindBuffer(file.rdbuf()));
+        }
+
+        void write(const Bid& bid) {
+            char head[3 * 10 + sizeof(double)];
+            char* end = length(length(length(head, bid.bidId.size()), bid.title.size()), bid.fund.size());
+            std::memcpy(end, &bid.amount, sizeof(double));
+            end += sizeof(double);
+            buffer->sputn(head, end - head);
+            buffer->sputn(bid.bidId.data(), static_cast<std::streamsize>(bid.bidId.size()));
+            buffer->sputn(bid.title.data(), static_cast<std::streamsize>(bid.title.size()));
+            buffer->sputn(bid.fund.data(), static_cast<std::streamsize>(bid.fund.size()));
+            bytes += static_cast<size_t>(end - head) + bid.bidId.size() + bid.title.size() + bid.fund.size();
+        }
+
+        /**
+         * Waits for the writes to finish and closes the file
+         *
+         * @return Bytes written
+         * @throws std::runtime_error if any write failed
+         */
+        size_t finish() {
+            bool ok = buffer->close();
+            file.close();
+            if (!ok || !file) {
+                throw std::runtime_error("cannot write run file " + path);
+            }
+            return bytes;
+        }
+
+        const std::string& name() const { return path; }
+
+    private:
+        static char* length(char* out, size_t value) {
+            while (value >= 0x80) {
+                *out++ = static_cast<char>((value & 0x7f) | 0x80);
+                value >>= 7;
+            }
+            *out++ = static_cast<char>(value);
+            return out;
+        }
+
+        std::string path;
+        std::ofstream file;
+        std::unique_ptr<WriteBehindBuffer> buffer;   // after file: stops writing before it closes
+        size_t bytes;
+    };
+
+    struct Block {
+        std::vector<char> data;
+        size_t size = 0;
+    };
+
+    /**
+     * The runs of one merge pass: decodes each run's records from blocks
+     * a shared read-ahead thread fills. A run has two blocks, one being
+     * merged and one in flight, passed back and forth on SpscQueues.
+     */
+    class RunSet {
+    public:
+        RunSet(const std::vector<std::string>& paths, size_t blockSize) : stopping(false), failed(false) {
+            for (const auto& path : paths) {
+                runs.emplace_back(new Run(path, blockSize, failed, handBacks));
+            }
+            reader = std::thread([this]() { readAhead(); });
+        }
+
+        ~RunSet() { stop(); }
+
+        RunSet(const RunSet&) = delete;
+        RunSet& operator=(const RunSet&) = delete;
+
+        size_t size() const { return runs.size(); }
+
+        /**
+         * Decodes the next record of one run into bid; its text stays valid
+         * until the next call for the same run
+         *
+         * @return false at the end of the run
+         */
+        bool next(size_t run, Bid& bid) { return runs[run]->next(bid); }
+
+        /**
+         * Stops the read-ahead thread and rethrows any error it hit
+         */
+        void finish() {
+            stop();
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+
+    private:
+        /**
+         * Counts the blocks the merge hands back, so the read-ahead thread
+         * can sleep until there is one to refill
+         */
+        struct HandBacks {
+            std::mutex lock;
+            std::condition_variable arrived;
+            size_t count = 0;
+
+            void signal() {
+                {
+                    std::lock_guard<std::mutex> guard(lock);
+                    ++count;
+                }
+                arrived.notify_one();
+            }
+
+            size_t seen() {
+                std::lock_guard<std::mutex> guard(lock);
+                return count;
+            }
+        };
+
+        class Run {
+        public:
+            Run(const std::string& path, size_t blockSize, const std::atomic<bool>& failed, HandBacks& handBacks)
+                : path(path), freeBlocks(2), fullBlocks(2), current(nullptr), position(0),
+                  exhausted(false), failed(failed), handBacks(handBacks) {
+                file.rdbuf()->pubsetbuf(nullptr, 0);
+                file.open(path, std::ios::in | std::ios::binary);
+                if (!file.is_open()) {
+                    throw std::runtime_error("cannot open run file " + path);
+                }
+                for (auto& block : blocks) {
+                    block.data.resize(blockSize);
+                    freeBlocks.tryPush(&block);
+                }
+            }
+
+            bool next(Bid& bid) {
+                unsigned char first;
+                if (!byte(first, false)) {
+                    return false;
+                }
+                size_t idSize = length(first);
+                size_t titleSize = length();
+                size_t fundSize = length();
+                const char* body = take(sizeof(double) + idSize + titleSize + fundSize);
+                std::memcpy(&bid.amount, body, sizeof(double));
+                body += sizeof(double);
+                bid.bidId = std::string_view(body, idSize);
+                bid.title = std::string_view(body + idSize, titleSize);
+                bid.fund = std::string_view(body + idSize + titleSize, fundSize);
+                return true;
+            }
+
+            /**
+             * Read-ahead side: fills a free block if the run has one
+             *
+             * @return false if there was nothing to do
+             */
+            bool fill() {
+                Block* block;
+                if (exhausted || !freeBlocks.tryPop(block)) {
+                    return false;
+                }
+                file.read(block->data.data(), static_cast<std::streamsize>(block->data.size()));
+                block->size = static_cast<size_t>(file.gcount());
+                if (file.bad()) {
+                    throw std::runtime_error("cannot read run file " + path);
+                }
+                if (block->size > 0) {
+                    fullBlocks.push(block);
+                }
+                if (block->size < block->data.size()) {
+                    exhausted = true;
+                    fullBlocks.close();
+                }
+                return true;
+            }
+
+            bool done() const { return exhausted; }
+
+            void cancel() {
+                freeBlocks.cancel();
+                fullBlocks.cancel();
+            }
+
+        private:
+            /**
+             * Moves to the next block, handing the finished one back
+             */
+            bool advance() {
+                if (current) {
+                    freeBlocks.push(current);
+                    current = nullptr;
+                    handBacks.signal();
+                }
+                Block* block;
+                if (!fullBlocks.pop(block)) {
+                    if (failed.load(std::memory_order_acquire)) {
+                        throw std::runtime_error("cannot read run file " + path);
+                    }
+                    return false;
+                }
+                current = block;
+                position = 0;
+                return true;
+            }
+
+            bool byte(unsigned char& value, bool required) {
+                if ((!current || position == current->size) && !advance()) {
+                    if (required) {
+                        throw std::runtime_error("run file " + path + " is truncated");
+                    }
+                    return false;
+                }
+                value = static_cast<unsigned char>(current->data[position++]);
+                return true;
+            }
+
+            size_t length(unsigned char first) {
+                size_t value = first & 0x7f;
+                unsigned char next = first;
+                for (unsigned shift = 7; next & 0x80; shift += 7) {
+                    if (shift >= 64) {
+                        throw std::runtime_error("run file " + path + " is corrupt");
+                    }
+                    byte(next, true);
+                    value |= static_cast<size_t>(next & 0x7f) << shift;
+                }
+                return value;
+            }
+
+            size_t length() {
+                unsigned char first;
+                byte(first, true);
+                return length(first);
+            }
+
+            /**
+             * @return size contiguous bytes: in place if the current block
+             *         holds them all, else gathered into scratch
+             */
+            const char* take(size_t size) {
+                if (current && current->size - position >= size) {
+                    const char* bytes = current->data.data() + position;
+                    position += size;
+                    return bytes;
+                }
+                scratch.resize(size);
+                size_t copied = 0;
+                while (copied < size) {
+                    if ((!current || position == current->size) && !advance()) {
+                        throw std::runtime_error("run file " + path + " is truncated");
+                    }
+                    size_t part = std::min(size - copied, current->size - position);
+                    std::memcpy(&scratch[copied], current->data.data() + position, part);
+                    position += part;
+                    copied += part;
+                }
+                return scratch.data();
+            }
+
+            std::string path;
+            std::ifstream file;             // read-ahead thread only
+            Block blocks[2];
+            SpscQueue<Block*> freeBlocks;   // merge to read-ahead
+            SpscQueue<Block*> fullBlocks;   // read-ahead to merge
+            Block* current;                 // being decoded
+            size_t position;
+            std::string scratch;            // a record that straddles two blocks
+            bool exhausted;                 // read-ahead thread only
+            const std::atomic<bool>& failed;
+            HandBacks& handBacks;
+        };
+
+        /**
+         * Read-ahead thread: sweeps the runs, refilling every block the
+         * merge has handed back, until all runs are read. A sweep that
+         * finds nothing to refill sleeps until the merge hands a block back.
+         */
+        void readAhead() {
+            try {
+                size_t active = runs.size();
+                while (active > 0 && !stopping.load(std::memory_order_acquire)) {
+                    size_t seen = handBacks.seen();
+                    bool progress = false;
+                    active = 0;
+                    for (auto& run : runs) {
+                        progress = run->fill() || progress;
+                        active += run->done() ? 0 : 1;
+                    }
+                    if (!progress && active > 0) {
+                        std::unique_lock<std::mutex> lock(handBacks.lock);
+                        handBacks.arrived.wait(lock, [&]() {
+                            return handBacks.count != seen || stopping.load(std::memory_order_acquire);
+                        });
+                    }
+                }
+            }
+            catch (...) {
+                error = std::current_exception();
+                failed.store(true, std::memory_order_release);
+                for (auto& run : runs) {
+                    run->cancel();
+                }
+            }
+        }
+
+        void stop() {
+            if (reader.joinable()) {
+                stopping.store(true, std::memory_order_release);
+                for (auto& run : runs) {
+                    run->cancel();
+                }
+                handBacks.signal();
+                reader.join();
+            }
+        }
+
+        HandBacks handBacks;
+        std::vector<std::unique_ptr<Run>> runs;
+        std::atomic<bool> stopping;
+        std::atomic<bool> failed;
+        std::exception_ptr error;
+        std::thread reader;
+    };
+
+    /**
+     * Tournament tree of losers over the heads of k runs
+     *
+     * Node 0 holds the overall winner and nodes 1..k-1 the loser of the
+     * match played there; run i plays from leaf k + i. Taking the winner
+     * replays only its path, one comparison per level.
+     */
+    template<typename Less>
+    class LoserTree {
+    public:
+        LoserTree(RunSet& runs, Less less) : runs(runs), less(less), heads(runs.size()),
+                                             live(runs.size()), tree(runs.size()) {
+            size_t k = runs.size();
+            for (size_t i = 0; i < k; ++i) {
+                live[i] = runs.next(i, heads[i]);
+            }
+            std::vector<size_t> winners(2 * k);
+            for (size_t i = 0; i < k; ++i) {
+                winners[k + i] = i;
+            }
+            for (size_t node = k - 1; node >= 1; --node) {
+                size_t a = winners[2 * node];
+                size_t b = winners[2 * node + 1];
+                bool aWins = beats(a, b);
+                winners[node] = aWins ? a : b;
+                tree[node] = aWins ? b : a;
+            }
+            tree[0] = winners[1];
+        }
+
+        bool empty() const { return !live[tree[0]]; }
+        const Bid& top() const { return heads[tree[0]]; }
+
+        /**
+         * Replaces the winner with the next bid of its run
+         */
+        void pop() {
+            size_t winner = tree[0];
+            live[winner] = runs.next(winner, heads[winner]);
+            for (size_t node = (heads.size() + winner) / 2; node >= 1; node /= 2) {
+                if (beats(tree[node], winner)) {
+                    std::swap(tree[node], winner);
+                }
+            }
+            tree[0] = winner;
+        }
+
+    private:
+        /**
+         * @return true if run a's head goes out before run b's; an ended
+         *         run loses to everything, and ties go to the earlier run
+         */
+        bool beats(size_t a, size_t b) const {
+            if (!live[a] || !live[b]) {
+                return live[a];
+            }
+            if (less(heads[b], heads[a])) {
+                return false;
+            }
+            return a < b || less(heads[a], heads[b]);
+        }
+
+        RunSet& runs;
+        Less less;
+        std::vector<Bid> heads;
+        std::vector<char> live;
+        std::vector<size_t> tree;
+    };
+
+    /**
+     * Merges sorted runs into output(const Bid&)
+     */
+    template<typename Less, typename Output>
+    void merge(const std::vector<std::string>& paths, Less less, Output& output) {
+        // Two blocks per run, all within the budget, but large enough that
+        // each read amortizes its seek
+        size_t blockSize = std::min<size_t>(1 << 20, std::max<size_t>(1 << 16, memoryBudget / (2 * paths.size())));
+        RunSet runs(paths, blockSize);
+        try {
+            LoserTree<Less> tree(runs, less);
+            while (!tree.empty()) {
+                output(tree.top());
+                tree.pop();
+            }
+        }
+        catch (...) {
+            runs.finish();  // a read-ahead error is the cause; report that one
+            throw;
+        }
+        runs.finish();
+    }
+
+    template<typename Less, typename Output>
+    ExternalSortStats sortBy(const std::string& csvPath, const SortSpec& order, Less less, Output& output) {
+        auto started = Clock::now();
+        ExternalSortStats stats;
+        RunDirectory directory(tempDirectory);
+        std::vector<std::string> runs;
+        BidArena arena(std::min<size_t>(1 << 20, memoryBudget / 8));
+        std::vector<Bid> bids;
+        std::unique_ptr<RunWriter> spilling;    // the last run, possibly still being written
+
+        auto sortBids = [&]() {
+            auto start = Clock::now();
+            sortRun(bids, order);
+            stats.sortMs += elapsedMs(start);
+        };
+        auto spill = [&]() {
+            sortBids();
+            if (spilling) {
+                stats.spilledBytes += spilling->finish();
+            }
+            spilling.reset(new RunWriter(directory.newRun()));
+            for (const auto& bid : bids) {
+                spilling->write(bid);
+            }
+            runs.push_back(spilling->name());
+            bids.clear();
+            arena.release();
+        };
+
+        LoadTimings timings;
+        BidLoader::stream(csvPath, timings, [&](const csv::RowView& row) {
+            BidLoader::build(row, arena, bids.emplace_back());
+            ++stats.rows;
+            if (arena.bytesUsed() + bids.size() * sizeof(Bid) >= memoryBudget) {
+                spill();
+            }
+        });
+
+        if (runs.empty()) {
+            sortBids();
+            stats.runMs = elapsedMs(started);
+            auto start = Clock::now();
+            for (const auto& bid : bids) {
+                output(bid);
+            }
+            stats.mergeMs = elapsedMs(start);
+            stats.totalMs = elapsedMs(started);
+            return stats;
+        }
+        if (!bids.empty()) {
+            spill();
+        }
+        stats.spilledBytes += spilling->finish();
+        spilling.reset();
+        std::vector<Bid>().swap(bids);
+        arena.release();
+        stats.runs = runs.size();
+        stats.runMs = elapsedMs(started);
+
+        auto start = Clock::now();
+        while (runs.size() > fanIn) {
+            std::vector<std::string> merged;
+            for (size_t first = 0; first < runs.size(); first += fanIn) {
+                std::vector<std::string> group(runs.begin() + first,
+                                               runs.begin() + std::min(first + fanIn, runs.size()));
+                if (group.size() == 1) {
+                    merged.push_back(group[0]);
+                    continue;
+                }
+                RunWriter out(directory.newRun());
+                auto write = [&out](const Bid& bid) { out.write(bid); };
+                merge(group, less, write);
+                stats.spilledBytes += out.finish();
+                for (const auto& path : group) {
+                    std::error_code ignored;
+                    std::filesystem::remove(path, ignored);
+                }
+                merged.push_back(out.name());
+            }
+            runs.swap(merged);
+            ++stats.mergePasses;
+        }
+        merge(runs, less, output);
+        stats.mergeMs = elapsedMs(start);
+        stats.totalMs = elapsedMs(started);
+        return stats;
+    }
+};
+
+#endif /*!_EXTERNALSORT_HPP_*/
@@ -0,0 +1,32 @@
+//============================================================================
+// Name        : Instrumentation.cpp
+// Description : Global allocation hooks feeding Instrumentation's counters
+//============================================================================
+
+#include <cstdlib>
+#include <new>
+
+#include "Instrumentation.hpp"
+
+// Replacing the throwing forms is enough: the array and nothrow forms of
+// the standard library call these. When no Scope is alive the only extra
+// work is one relaxed load per allocation.
+
+void* operator new(std::size_t size) {
+    Instrumentation::noteAllocation(size);
+    if (size == 0) {
+        size = 1;
+    }
+    if (void* memory = std::malloc(size)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
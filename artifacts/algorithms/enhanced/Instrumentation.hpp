@@ -0,0 +1,272 @@
+//============================================================================
+// Name        : Instrumentation.hpp
+// Description : Hardware counters and operation counts for benchmark runs
+//============================================================================
+
+#ifndef _INSTRUMENTATION_HPP_
+#define _INSTRUMENTATION_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Hardware counts of one measured run; -1 where a counter is unavailable
+ */
+struct PerfSample {
+    int64_t cycles = -1;
+    int64_t instructions = -1;
+    int64_t cacheMisses = -1;
+    int64_t branchMisses = -1;
+};
+
+/**
+ * Operation counts of one measured run; -1 where not collected
+ */
+struct OpCounts {
+    int64_t comparisons = -1;
+    int64_t copies = -1;          // element copy constructions and assignments
+    int64_t moves = -1;           // element move constructions and assignments; a swap is three
+    int64_t stringCopies = -1;    // strings copied into a BidArena
+    int64_t allocations = -1;
+    int64_t bytesAllocated = -1;
+};
+
+/**
+ * Process-wide operation counters and the switch that turns collection on
+ *
+ * Comparisons, copies and moves are counted by CountingLess and Counted, so
+ * only runs over those types see them. Allocations are counted by the
+ * global operator new in Instrumentation.cpp, and string copies by
+ * BidArena, while a Scope is alive. The counters are relaxed atomics, so
+ * work on pool threads is counted too.
+ */
+class Instrumentation {
+public:
+    /**
+     * @return true if benchmarks should collect counters (off by default)
+     */
+    static bool enabled() { return active.load(); }
+    static void setEnabled(bool on) { active.store(on); }
+
+    static void countComparison() { comparisonCount.fetch_add(1, std::memory_order_relaxed); }
+    static void countCopy() { copyCount.fetch_add(1, std::memory_order_relaxed); }
+    static void countMove() { moveCount.fetch_add(1, std::memory_order_relaxed); }
+
+    static void noteStringCopy() {
+        if (tracking.load(std::memory_order_relaxed)) {
+            stringCopyCount.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    static void noteAllocation(size_t bytes) {
+        if (tracking.load(std::memory_order_relaxed)) {
+            allocationCount.fetch_add(1, std::memory_order_relaxed);
+            allocatedBytes.fetch_add(bytes, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Zeroes the counters and counts everything until destroyed; scopes
+     * do not nest
+     */
+    class Scope {
+    public:
+        Scope() {
+            comparisonCount.store(0);
+            copyCount.store(0);
+            moveCount.store(0);
+            stringCopyCount.store(0);
+            allocationCount.store(0);
+            allocatedBytes.store(0);
+            tracking.store(true);
+        }
+
+        ~Scope() { tracking.store(false); }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        OpCounts counts() const {
+            OpCounts counts;
+            counts.comparisons = static_cast<int64_t>(comparisonCount.load());
+            counts.copies = static_cast<int64_t>(copyCount.load());
+            counts.moves = static_cast<int64_t>(moveCount.load());
+            counts.stringCopies = static_cast<int64_t>(stringCopyCount.load());
+            counts.allocations = static_cast<int64_t>(allocationCount.load());
+            counts.bytesAllocated = static_cast<int64_t>(allocatedBytes.load());
+            return counts;
+        }
+    };
+
+private:
+    static inline std::atomic<bool> active{ false };
+    static inline std::atomic<bool> tracking{ false };
+    static inline std::atomic<uint64_t> comparisonCount{ 0 };
+    static inline std::atomic<uint64_t> copyCount{ 0 };
+    static inline std::atomic<uint64_t> moveCount{ 0 };
+    static inline std::atomic<uint64_t> stringCopyCount{ 0 };
+    static inline std::atomic<uint64_t> allocationCount{ 0 };
+    static inline std::atomic<uint64_t> allocatedBytes{ 0 };
+};
+
+/**
+ * Element whose copies and moves are counted apart, for running the generic
+ * BidSorter algorithms in a counted pass: a sort that moves where it can
+ * shows (nearly) no copies
+ */
+template<typename T>
+struct Counted {
+    T value;
+
+    Counted() : value() {}
+    Counted(const T& value) : value(value) {}
+
+    Counted(const Counted& other) : value(other.value) {
+        Instrumentation::countCopy();
+    }
+
+    Counted(Counted&& other) noexcept : value(std::move(other.value)) {
+        Instrumentation::countMove();
+    }
+
+    Counted& operator=(const Counted& other) {
+        value = other.value;
+        Instrumentation::countCopy();
+        return *this;
+    }
+
+    Counted& operator=(Counted&& other) noexcept {
+        value = std::move(other.value);
+        Instrumentation::countMove();
+        return *this;
+    }
+};
+
+/**
+ * Comparator over Counted elements that counts each call and defers to less
+ */
+template<typename Less>
+struct CountingLess {
+    Less less;
+
+    explicit CountingLess(Less less) : less(less) {}
+
+    template<typename T>
+    bool operator()(const Counted<T>& a, const Counted<T>& b) const {
+        Instrumentation::countComparison();
+        return less(a.value, b.value);
+    }
+};
+
+/**
+ * Cycles, instructions, cache misses and branch misses of the calling
+ * thread, read through perf_event_open on Linux
+ *
+ * Each counter is opened on its own, so any the kernel or the host refuses
+ * (perf_event_paranoid, containers, virtual machines without a PMU, other
+ * systems) just reads as -1. Work done on pool threads is not included.
+ */
+class PerfCounters {
+public:
+    PerfCounters() {
+        for (int i = 0; i < COUNTERS; ++i) {
+            fds[i] = -1;
+        }
+#if defined(__linux__)
+        static const uint64_t configs[COUNTERS] = {
+            PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+        };
+        for (int i = 0; i < COUNTERS; ++i) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.size = sizeof(attr);
+            attr.config = configs[i];
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            fds[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        }
+#endif
+    }
+
+    ~PerfCounters() {
+#if defined(__linux__)
+        for (int i = 0; i < COUNTERS; ++i) {
+            if (fds[i] >= 0) {
+                close(fds[i]);
+            }
+        }
+#endif
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    /**
+     * @return true if at least one counter could be opened
+     */
+    bool available() const {
+        for (int i = 0; i < COUNTERS; ++i) {
+            if (fds[i] >= 0) return true;
+        }
+        return false;
+    }
+
+    /**
+     * Zeroes and starts every open counter
+     */
+    void start() {
+#if defined(__linux__)
+        for (int i = 0; i < COUNTERS; ++i) {
+            if (fds[i] >= 0) {
+                ioctl(fds[i], PERF_EVENT_IOC_RESET, 0);
+                ioctl(fds[i], PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+#endif
+    }
+
+    /**
+     * Stops the counters
+     *
+     * @return Counts since start()
+     */
+    PerfSample stop() {
+        int64_t values[COUNTERS] = { -1, -1, -1, -1 };
+#if defined(__linux__)
+        for (int i = 0; i < COUNTERS; ++i) {
+            if (fds[i] >= 0) {
+                ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
+                uint64_t count = 0;
+                if (read(fds[i], &count, sizeof(count)) == static_cast<ssize_t>(sizeof(count))) {
+                    values[i] = static_cast<int64_t>(count);
+                }
+            }
+        }
+#endif
+        PerfSample sample;
+        sample.cycles = values[0];
+        sample.instructions = values[1];
+        sample.cacheMisses = values[2];
+        sample.branchMisses = values[3];
+        return sample;
+    }
+
+private:
+    static const int COUNTERS = 4;
+    int fds[COUNTERS];
+};
+
+#endif /*!_INSTRUMENTATION_HPP_*/
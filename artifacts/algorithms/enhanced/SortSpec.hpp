@@ -0,0 +1,245 @@
+//============================================================================
+// Name        : SortSpec.hpp
+// Description : Field comparators and parsed multi-key sort orders for Bid
+//============================================================================
+
+#ifndef _SORTSPEC_HPP_
+#define _SORTSPEC_HPP_
+
+#include <cctype>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "Bid.hpp"
+
+/**
+ * Bid fields a sort can key on
+ */
+enum BidField { eBID_ID = 0, eTITLE = 1, eFUND = 2, eAMOUNT = 3 };
+
+/**
+ * Three-way comparison of one field of two bids
+ *
+ * @return Negative, zero or positive as a's field is less, equal or greater
+ */
+template<BidField Field>
+inline int compareField(const Bid& a, const Bid& b) {
+    if constexpr (Field == eAMOUNT) {
+        return (a.amount < b.amount) ? -1 : (b.amount < a.amount) ? 1 : 0;
+    }
+    else if constexpr (Field == eBID_ID) {
+        return a.bidId.compare(b.bidId);
+    }
+    else if constexpr (Field == eFUND) {
+        return a.fund.compare(b.fund);
+    }
+    else {
+        return a.title.compare(b.title);
+    }
+}
+
+inline int compareField(BidField field, const Bid& a, const Bid& b) {
+    switch (field) {
+    case eBID_ID: return compareField<eBID_ID>(a, b);
+    case eFUND:   return compareField<eFUND>(a, b);
+    case eAMOUNT: return compareField<eAMOUNT>(a, b);
+    default:      return compareField<eTITLE>(a, b);
+    }
+}
+
+/**
+ * Compile-time single key: orders bids by Field, optionally descending
+ */
+template<BidField Field, bool Descending = false>
+struct FieldLess {
+    static const BidField field = Field;
+    static const bool descending = Descending;
+
+    static int compare(const Bid& a, const Bid& b) {
+        return Descending ? compareField<Field>(b, a) : compareField<Field>(a, b);
+    }
+
+    bool operator()(const Bid& a, const Bid& b) const {
+        return compare(a, b) < 0;
+    }
+};
+
+/**
+ * Compile-time lexicographic order over FieldLess keys, e.g.
+ * ThenBy<FieldLess<eAMOUNT, true>, FieldLess<eFUND>, FieldLess<eTITLE>>.
+ * Each key is compared once (three-way) and the chain inlines completely.
+ */
+template<typename... Keys>
+struct ThenBy {
+    static int compare(const Bid& a, const Bid& b) {
+        int result = 0;
+        // Stops at the first key that tells the bids apart
+        (void)((result = Keys::compare(a, b), result == 0) && ...);
+        return result;
+    }
+
+    bool operator()(const Bid& a, const Bid& b) const {
+        return compare(a, b) < 0;
+    }
+};
+
+/**
+ * One key of a runtime sort order
+ */
+struct SortKeySpec {
+    BidField field;
+    bool descending;
+};
+
+/**
+ * Runtime multi-key sort order, parsed from text such as
+ * "amount:desc,fund,title", and usable directly as a BidSorter comparator.
+ * All keys are checked in a single comparison, so a multi-key order costs
+ * one sort, not one pass per key. Keys live in a fixed array (each field
+ * at most once), so a SortSpec is as cheap to pass by value as any other
+ * comparator.
+ */
+class SortSpec {
+public:
+    static const size_t MAX_KEYS = 4;
+
+    /**
+     * Default order: title ascending, which is what every sort used before
+     */
+    SortSpec() : count(1) {
+        fields[0] = SortKeySpec{ eTITLE, false };
+    }
+
+    /**
+     * Parses a comma separated list of field[:asc|:desc] keys; fields are
+     * id (or bidid), title, fund and amount, case-insensitive
+     *
+     * @param spec Text to parse
+     * @throws std::invalid_argument on an empty key, an unknown field or
+     *         direction, or a field listed twice
+     */
+    explicit SortSpec(const std::string& spec) : count(0) {
+        size_t start = 0;
+        while (start <= spec.size()) {
+            size_t comma = spec.find(',', start);
+            if (comma == std::string::npos) {
+                comma = spec.size();
+            }
+            std::string key = lower(trim(spec.substr(start, comma - start)));
+            std::string direction;
+            size_t colon = key.find(':');
+            if (colon != std::string::npos) {
+                direction = trim(key.substr(colon + 1));
+                key = trim(key.substr(0, colon));
+            }
+
+            if (key.empty()) {
+                throw std::invalid_argument("empty sort key");
+            }
+
+            SortKeySpec parsed;
+            if (key == "id" || key == "bidid") parsed.field = eBID_ID;
+            else if (key == "title") parsed.field = eTITLE;
+            else if (key == "fund") parsed.field = eFUND;
+            else if (key == "amount") parsed.field = eAMOUNT;
+            else throw std::invalid_argument("unknown sort field '" + key + "'");
+
+            if (direction.empty() || direction == "asc") parsed.descending = false;
+            else if (direction == "desc") parsed.descending = true;
+            else throw std::invalid_argument("unknown sort direction '" + direction + "'");
+
+            for (size_t i = 0; i < count; ++i) {
+                if (fields[i].field == parsed.field) {
+                    throw std::invalid_argument("sort field '" + key + "' listed twice");
+                }
+            }
+            fields[count++] = parsed;
+            start = comma + 1;
+        }
+    }
+
+    bool operator()(const Bid& a, const Bid& b) const {
+        for (size_t i = 0; i < count; ++i) {
+            int result = compareField(fields[i].field, a, b);
+            if (result != 0) {
+                return fields[i].descending ? result > 0 : result < 0;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @return true for plain title ascending, which the sorters serve with
+     *         their hand-specialized TitleLess instantiations
+     */
+    bool isTitleOnly() const {
+        return count == 1 && fields[0].field == eTITLE && !fields[0].descending;
+    }
+
+    /**
+     * @return true if this order is exactly the FieldLess Keys, e.g.
+     *         matches<FieldLess<eFUND>, FieldLess<eTITLE>>() for "fund,title"
+     */
+    template<typename... Keys>
+    bool matches() const {
+        const SortKeySpec keys[] = { SortKeySpec{ Keys::field, Keys::descending }... };
+        if (count != sizeof...(Keys)) return false;
+        for (size_t i = 0; i < count; ++i) {
+            if (fields[i].field != keys[i].field || fields[i].descending != keys[i].descending) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    size_t size() const { return count; }
+    const SortKeySpec& operator[](size_t i) const { return fields[i]; }
+
+    /**
+     * @return This order without its first key; compares all bids equal if
+     *         that was the only key
+     */
+    SortSpec rest() const {
+        SortSpec tail;
+        tail.count = 0;
+        for (size_t i = 1; i < count; ++i) {
+            tail.fields[tail.count++] = fields[i];
+        }
+        return tail;
+    }
+
+    /**
+     * @return The order in the same notation the constructor parses
+     */
+    std::string str() const {
+        static const char* names[] = { "id", "title", "fund", "amount" };
+        std::string text;
+        for (size_t i = 0; i < count; ++i) {
+            if (!text.empty()) text += ',';
+            text += names[fields[i].field];
+            if (fields[i].descending) text += ":desc";
+        }
+        return text;
+    }
+
+private:
+    static std::string trim(const std::string& text) {
+        size_t first = text.find_first_not_of(" \t");
+        if (first == std::string::npos) return std::string();
+        size_t last = text.find_last_not_of(" \t");
+        return text.substr(first, last - first + 1);
+    }
+
+    static std::string lower(std::string text) {
+        for (auto& c : text) {
+            c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+        return text;
+    }
+
+    SortKeySpec fields[MAX_KEYS];
+    size_t count;
+};
+
+#endif /*!_SORTSPEC_HPP_*/
@@ -0,0 +1,206 @@
+//============================================================================
+// Name        : SpscQueue.hpp
+// Description : Bounded lock-free queue between one producer and one consumer
+//============================================================================
+
+#ifndef _SPSCQUEUE_HPP_
+#define _SPSCQUEUE_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Fixed-capacity ring buffer for exactly one producer thread and one
+ * consumer thread
+ *
+ * Each side owns one index and only reads the other's, so a push or pop
+ * is a relaxed load of its own index, an acquire load of the other, a
+ * release store and a fence to check for a sleeping peer: no locks and no
+ * read-modify-write operations while neither side waits. The indices sit
+ * on separate cache lines so the two threads do not share one.
+ *
+ * push() and pop() spin briefly while the ring is full or empty, then
+ * sleep on a condition variable until the other side pops or pushes,
+ * close()s or cancel()s, so a stalled stage costs no CPU. The producer
+ * close()s the queue when it is done; either side may cancel() it to
+ * abandon the transfer, e.g. after an error, which wakes the other.
+ */
+template<typename T>
+class SpscQueue {
+public:
+    /**
+     * @param capacity Items the ring holds; rounded up to a power of two
+     */
+    explicit SpscQueue(size_t capacity) : head(0), tail(0), closed(false), cancelled(false), sleepers(0) {
+        size_t size = 2;
+        while (size < capacity) {
+            size *= 2;
+        }
+        slots.resize(size);
+        mask = size - 1;
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    /**
+     * Producer: adds an item if there is room
+     *
+     * @return false if the ring is full
+     */
+    bool tryPush(const T& value) {
+        if (!add(value)) {
+            return false;
+        }
+        wakePeer();
+        return true;
+    }
+
+    /**
+     * Consumer: takes the oldest item if there is one
+     *
+     * @return false if the ring is empty
+     */
+    bool tryPop(T& value) {
+        if (!take(value)) {
+            return false;
+        }
+        wakePeer();
+        return true;
+    }
+
+    /**
+     * Producer: adds an item, waiting for room
+     *
+     * @return false if the queue was cancelled; the item was not added
+     */
+    bool push(const T& value) {
+        bool added = false;
+        await([&]() {
+            added = add(value);
+            return added || cancelled.load(std::memory_order_acquire);
+        });
+        if (added) {
+            wakePeer();
+        }
+        return added;
+    }
+
+    /**
+     * Consumer: takes the oldest item, waiting for one
+     *
+     * @return false once the queue is closed and drained, or cancelled
+     */
+    bool pop(T& value) {
+        bool taken = false;
+        await([&]() {
+            taken = take(value);
+            if (taken || cancelled.load(std::memory_order_acquire)) {
+                return true;
+            }
+            if (closed.load(std::memory_order_acquire)) {
+                // Items pushed before close() are visible once it is
+                taken = take(value);
+                return true;
+            }
+            return false;
+        });
+        if (taken) {
+            wakePeer();
+        }
+        return taken;
+    }
+
+    /**
+     * Producer: no more items will be pushed
+     */
+    void close() {
+        closed.store(true, std::memory_order_release);
+        wakePeer();
+    }
+
+    /**
+     * Either side: abandons the queue, failing every pending and later
+     * push() and pop()
+     */
+    void cancel() {
+        cancelled.store(true, std::memory_order_release);
+        wakePeer();
+    }
+
+private:
+    // Yields before sleeping; enough to ride out a peer that is about to
+    // push or pop, far less than a stage stalled on I/O or a whole sort
+    static const unsigned SPINS = 64;
+
+    bool add(const T& value) {
+        size_t back = tail.load(std::memory_order_relaxed);
+        if (back - head.load(std::memory_order_acquire) == slots.size()) {
+            return false;
+        }
+        slots[back & mask] = value;
+        tail.store(back + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool take(T& value) {
+        size_t front = head.load(std::memory_order_relaxed);
+        if (front == tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = slots[front & mask];
+        head.store(front + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Returns once ready() does: after spinning a little, asleep until a
+     * wakePeer() call. A sleeper registers before its last check, and the
+     * waker fences between its change and looking for sleepers, so one of
+     * the two always sees the other; the mutex makes the notify land after
+     * the sleeper is waiting.
+     */
+    template<typename Ready>
+    void await(Ready ready) {
+        for (unsigned spin = 0; spin < SPINS; ++spin) {
+            if (ready()) {
+                return;
+            }
+            std::this_thread::yield();
+        }
+        std::unique_lock<std::mutex> lock(sleep);
+        sleepers.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        while (!ready()) {
+            wake.wait(lock);
+        }
+        sleepers.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * Wakes the other side if it sleeps in await()
+     */
+    void wakePeer() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleepers.load(std::memory_order_relaxed) > 0) {
+            std::lock_guard<std::mutex> lock(sleep);
+            wake.notify_all();
+        }
+    }
+
+    std::vector<T> slots;
+    size_t mask;
+    alignas(64) std::atomic<size_t> head;   // next slot to pop; written by the consumer
+    alignas(64) std::atomic<size_t> tail;   // next slot to push; written by the producer
+    alignas(64) std::atomic<bool> closed;
+    std::atomic<bool> cancelled;
+    std::atomic<unsigned> sleepers;         // threads in await()'s sleep
+    std::mutex sleep;
+    std::condition_variable wake;
+};
+
+#endif /*!_SPSCQUEUE_HPP_*/
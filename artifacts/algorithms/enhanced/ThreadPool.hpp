@@ -0,0 +1,228 @@
+//============================================================================
+// Name        : ThreadPool.hpp
+// Description : Work-stealing thread pool for fork/join sorting
+//============================================================================
+
+#ifndef _THREADPOOL_HPP_
+#define _THREADPOOL_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * Fixed set of worker threads, each with its own task deque
+ *
+ * A worker pushes and pops its own deque at the back (newest first, which
+ * keeps recursive splits cache-warm) and, when it runs dry, steals from the
+ * front of the others (oldest, i.e. largest, subproblems first). Threads
+ * outside the pool submit through a shared injection deque.
+ *
+ * Work is forked into a TaskGroup and joined with wait(). A waiting thread
+ * keeps running queued tasks instead of blocking, so tasks may fork and
+ * wait on nested groups without starving the pool.
+ */
+class ThreadPool {
+public:
+    /**
+     * Counts the outstanding tasks forked into it and keeps the first
+     * exception one of them threw
+     */
+    class TaskGroup {
+    public:
+        TaskGroup() : pending(0) {}
+
+    private:
+        friend class ThreadPool;
+
+        std::atomic<size_t> pending;
+        std::mutex errorMutex;
+        std::exception_ptr error;
+    };
+
+    /**
+     * Starts the workers
+     *
+     * @param threads Number of workers; 0 means one per hardware thread
+     */
+    explicit ThreadPool(unsigned threads = 0) : queued(0), stopping(false) {
+        if (threads == 0) {
+            threads = std::thread::hardware_concurrency();
+        }
+        if (threads == 0) {
+            threads = 1;
+        }
+        // One deque per worker plus the injection deque at the end
+        for (unsigned i = 0; i <= threads; ++i) {
+            queues.emplace_back(new Queue());
+        }
+        for (unsigned i = 0; i < threads; ++i) {
+            workers.emplace_back([this, i] { workerLoop(i); });
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    /**
+     * @return Process-wide pool with one worker per hardware thread
+     */
+    static ThreadPool& shared() {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    size_t size() const { return workers.size(); }
+
+    /**
+     * Queues a task as part of group
+     *
+     * @param group Group that wait() will join on
+     * @param task Work to run on some pool thread
+     */
+    void run(TaskGroup& group, std::function<void()> task) {
+        group.pending.fetch_add(1);
+        Queue& queue = *queues[currentQueue()];
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks.push_back(Task{ std::move(task), &group });
+        }
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            queued.fetch_add(1);
+        }
+        wake.notify_one();
+    }
+
+    /**
+     * Runs queued tasks until every task forked into group has finished
+     *
+     * @param group Group to join
+     * @throws The first exception thrown by one of the group's tasks
+     */
+    void wait(TaskGroup& group) {
+        size_t self = currentQueue();
+        while (group.pending.load() != 0) {
+            if (!runOne(self)) {
+                std::this_thread::yield();
+            }
+        }
+        if (group.error) {
+            std::exception_ptr error = group.error;
+            group.error = nullptr;
+            std::rethrow_exception(error);
+        }
+    }
+
+private:
+    struct Task {
+        std::function<void()> function;
+        TaskGroup* group;
+    };
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    /**
+     * @return Pool and deque index of the calling thread (null pool if it
+     *         is not a worker)
+     */
+    static std::pair<const ThreadPool*, size_t>& threadSlot() {
+        static thread_local std::pair<const ThreadPool*, size_t> slot(nullptr, 0);
+        return slot;
+    }
+
+    size_t currentQueue() const {
+        const auto& slot = threadSlot();
+        return (slot.first == this) ? slot.second : workers.size();
+    }
+
+    /**
+     * Pops a task from the caller's own deque, or steals one
+     *
+     * @param self Caller's deque index
+     * @return false if every deque was empty
+     */
+    bool runOne(size_t self) {
+        Task task;
+        bool found = false;
+        {
+            Queue& own = *queues[self];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty()) {
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                found = true;
+            }
+        }
+        for (size_t i = 1; !found && i < queues.size(); ++i) {
+            Queue& victim = *queues[(self + i) % queues.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                found = true;
+            }
+        }
+        if (!found) {
+            return false;
+        }
+        queued.fetch_sub(1);
+
+        try {
+            task.function();
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(task.group->errorMutex);
+            if (!task.group->error) {
+                task.group->error = std::current_exception();
+            }
+        }
+        task.group->pending.fetch_sub(1);
+        return true;
+    }
+
+    void workerLoop(size_t index) {
+        threadSlot() = std::make_pair(this, index);
+        while (true) {
+            if (runOne(index)) {
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            wake.wait(lock, [this] { return stopping || queued.load() != 0; });
+            if (stopping) {
+                return;
+            }
+        }
+    }
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<size_t> queued;
+    bool stopping;
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+};
+
+#endif /*!_THREADPOOL_HPP_*/
@@ -0,0 +1,15 @@
+# Merges the raw Clang profiles of the pgo-train runs into the
+# default.profdata that ENHANCED_SORTING_PGO=USE builds read
+#
+#   cmake -DPROFDATA=llvm-profdata -DPROFILE_DIR=dir -P MergeProfiles.cmake
+
+file(GLOB raw "${PROFILE_DIR}/*.profraw")
+if(NOT raw)
+    message(FATAL_ERROR "No raw profiles in ${PROFILE_DIR}; did the training runs use the instrumented build?")
+endif()
+execute_process(COMMAND "${PROFDATA}" merge -output=${PROFILE_DIR}/default.profdata ${raw}
+    RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "llvm-profdata merge failed (${result})")
+endif()
+file(REMOVE ${raw})